@@ -0,0 +1,88 @@
+#ifndef ACTIVITY_COUNTER_H
+#define ACTIVITY_COUNTER_H
+
+#include "calendar.h"
+#include <algorithm>
+#include <ctime>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+// Per-id event counts for the current (local) day, kept ranked as they grow.
+// Counts only ever go up by one, so an id is swapped to the front of the run
+// of ids sharing its count and then bumped: every increment is O(1) and the
+// top K is simply the first K entries. The counts reset when the day changes.
+class DailyActivityCounter
+{
+private:
+    time_t day;
+    vector<pair<int, int>> ranking;          // (id, count), count descending
+    unordered_map<int, size_t> positions;    // id -> index in ranking
+    unordered_map<int, size_t> runStarts;    // count -> first index holding that count
+
+    void swapEntries(size_t a, size_t b)
+    {
+        swap(ranking[a], ranking[b]);
+        positions[ranking[a].first] = a;
+        positions[ranking[b].first] = b;
+    }
+
+public:
+    DailyActivityCounter() : day(-1) {}
+
+    // Count one event for id at timestamp; events from an earlier day are ignored
+    void add(int id, time_t timestamp)
+    {
+        time_t eventDay = localDay(timestamp);
+        if (eventDay < day)
+        {
+            return;
+        }
+        if (eventDay > day)
+        {
+            day = eventDay;
+            ranking.clear();
+            positions.clear();
+            runStarts.clear();
+        }
+
+        auto [position, inserted] = positions.try_emplace(id, ranking.size());
+        if (inserted)
+        {
+            // zero counts sort last, so a new id starts the tail run of zeros
+            ranking.push_back({id, 0});
+            runStarts.try_emplace(0, position->second);
+        }
+
+        size_t index = position->second;
+        int count = ranking[index].second;
+        size_t first = runStarts[count];
+        swapEntries(index, first);
+        ranking[first].second++;
+
+        if (first + 1 < ranking.size() && ranking[first + 1].second == count)
+        {
+            runStarts[count] = first + 1;
+        }
+        else
+        {
+            runStarts.erase(count);
+        }
+        runStarts.try_emplace(count + 1, first);
+    }
+
+    // Up to n (id, count) pairs with the most events on the day of now, busiest first
+    vector<pair<int, int>> top(size_t n, time_t now) const
+    {
+        if (localDay(now) != day)
+        {
+            return {};
+        }
+        size_t count = min(n, ranking.size());
+        return vector<pair<int, int>>(ranking.begin(), ranking.begin() + static_cast<ptrdiff_t>(count));
+    }
+};
+
+#endif // ACTIVITY_COUNTER_H
@@ -3,138 +3,482 @@
 
 #include "bank_customer.h"
 #include "transaction.h"
+#include "ledger.h"
+#include "slab.h"
+#include "wal.h"
+#include "daily_fenwick.h"
+#include "activity_counter.h"
+#include "calendar.h"
 #include <iostream>
 #include <vector>
 #include <algorithm>
+#include <array>
 #include <ctime>
-#include <map>
+#include <initializer_list>
+#include <iterator>
+#include <mutex>
+#include <set>
 
 using namespace std;
 
+// Running per-day credit and debit totals of one account
+struct DailyCashFlow
+{
+    DailyFenwick<Money> credit;
+    DailyFenwick<Money> debit;
+};
+
+// One account's ledger rows and the indexes derived from them, guarded by
+// the account's lock stripe
+struct AccountLedger
+{
+    AccountPostings postings; // the account's rows, in time order
+    DailyCashFlow cashFlow;
+    time_t lastActivity = 0; // 0 until the account's first transaction
+};
+
+// One ledger row produced by a mutation (amount and time come from its log record)
+struct LedgerEntry
+{
+    int accountId;
+    TransactionType type;
+    DescriptionKind kind;
+    uint32_t memo = 0;
+};
+
+// Non-owning view of one account's ledger rows, oldest first. The view is a
+// snapshot of the account's row range taken under the account's lock stripe;
+// rows are rendered as Transactions one at a time while iterating, each under
+// a brief hold of that stripe. Rows are append-only, so indices stay valid and
+// the Bank may be used freely (even by the same thread) while a view is alive.
+class TransactionView
+{
+public:
+    class Iterator
+    {
+    private:
+        const TransactionView *view = nullptr;
+        size_t index = 0;
+
+    public:
+        using iterator_category = input_iterator_tag;
+        using value_type = Transaction;
+        using difference_type = ptrdiff_t;
+        using reference = Transaction;
+
+        Iterator() = default;
+        Iterator(const TransactionView *view, size_t index) : view(view), index(index) {}
+
+        Transaction operator*() const
+        {
+            lock_guard<mutex> lock(*view->stripeLock);
+            return view->account->postings.at(index, view->accountId, *view->ledger);
+        }
+
+        Iterator &operator++()
+        {
+            index++;
+            return *this;
+        }
+
+        Iterator operator++(int)
+        {
+            Iterator copy = *this;
+            index++;
+            return copy;
+        }
+
+        bool operator==(const Iterator &other) const { return index == other.index; }
+    };
+
+    TransactionView() = default;
+    TransactionView(mutex &stripeLock, const Ledger &ledger, const AccountLedger &account, int accountId,
+                    size_t first, size_t last)
+        : stripeLock(&stripeLock), ledger(&ledger), account(&account), accountId(accountId), first(first), last(last) {}
+
+    Iterator begin() const { return Iterator(this, first); }
+    Iterator end() const { return Iterator(this, last); }
+    size_t size() const { return last - first; }
+    bool empty() const { return first == last; }
+
+private:
+    mutex *stripeLock = nullptr;
+    const Ledger *ledger = nullptr;
+    const AccountLedger *account = nullptr;
+    int accountId = 0;
+    size_t first = 0; // index range in the account's postings
+    size_t last = 0;
+};
+
+// Thread-safe bank.
+// Balances are atomics, so reading one never locks. Everything else about an
+// account (its ledger rows, cash flow buckets and activity entries) is
+// guarded by one of a fixed set of lock stripes. A balance change, its log
+// record and its ledger rows happen under the account's stripe, so each
+// account's rows are in the order its balance changed and replay can check
+// every debit. Only numbering the rows in log order (so ids survive a
+// replay) is serialized bank-wide; the index upkeep of accounts on different
+// stripes runs in parallel. Bank-wide queries visit the stripes one at a
+// time and merge their answers.
 class Bank
 {
 private:
+    static constexpr size_t AccountLockStripes = 64;
+
+    // The accounts whose ids fall on one lock stripe share its activity indexes
+    struct alignas(64) AccountStripe
+    {
+        mutex mtx;
+        set<pair<time_t, int>> activityIndex; // (last activity, account id), oldest first
+        DailyActivityCounter todayActivity;   // transactions per account today
+    };
+
     string name;
-    vector<BankCustomer *> Accounts;
-    vector<Transaction> transactions;
-    int customerCount;
-    int nextTransactionId;
+    Slab<BankCustomer> Accounts;         // account id N lives in slot N - 1
+    Slab<AccountLedger> accountLedgers;  // likewise; slot N - 1 exists before account N is published
+    mutex accountsMutex;                 // serializes account creation
+    mutable array<AccountStripe, AccountLockStripes> stripes; // multi-account operations lock in stripe order
+    Ledger ledger;
+    mutex sequenceMutex; // numbers ledger rows in log order; held only for that
+    WriteAheadLog *log; // mutations are not logged while null
+
+    size_t stripeOf(int accountId) const
+    {
+        return static_cast<size_t>(accountId - 1) % AccountLockStripes;
+    }
 
-public:
-    Bank(const string &name) : name(name), customerCount(0), nextTransactionId(1) {}
+    mutex &accountLock(int accountId) const { return stripes[stripeOf(accountId)].mtx; }
 
-    ~Bank()
+    // Add the row at offset to its account's postings and indexes; caller
+    // holds the account's lock stripe, or is replaying before the bank is shared
+    void post(size_t offset, const LedgerRecord &record)
     {
-        for (auto account : Accounts)
+        int accountId = record.customerId;
+        if (accountId < 1 || static_cast<size_t>(accountId) > accountLedgers.size())
+        {
+            return;
+        }
+        time_t timestamp = record.getTimestamp();
+        AccountStripe &stripe = stripes[stripeOf(accountId)];
+        AccountLedger &account = accountLedgers[accountId - 1];
+
+        account.postings.append(offset, record);
+        (record.getType() == CREDIT ? account.cashFlow.credit : account.cashFlow.debit)
+            .add(localDay(timestamp), record.getAmount());
+        stripe.todayActivity.add(accountId, timestamp);
+        if (timestamp > account.lastActivity)
         {
-            delete account;
+            stripe.activityIndex.erase({account.lastActivity, accountId});
+            account.lastActivity = timestamp;
+            stripe.activityIndex.insert({timestamp, accountId});
         }
     }
 
-    string getName() const { return name; }
+    // Give a new account its ledger slot and dormancy entry ahead of
+    // publishing it; caller holds the account's lock stripe
+    void addAccountLedger(int accountId)
+    {
+        accountLedgers.emplace_back();
+        stripes[stripeOf(accountId)].activityIndex.insert({0, accountId});
+    }
+
+    // Post a replayed row in log order
+    void post(const LedgerRecord &record) { post(ledger.append(), record); }
 
-    // Create new bank account
-    BankCustomer *createAccount(const string &customerName, double initialBalance)
+    // Log a mutation and post its ledger entries; caller holds the lock
+    // stripe of every entry's account. Rows are numbered together with the
+    // log append, so transaction ids follow the log and survive a replay.
+    // Returns the log sequence number to wait on, or 0 when nothing was logged.
+    uint64_t recordMutation(const WalRecord &record, initializer_list<LedgerEntry> entries)
     {
-        customerCount++;
-        BankCustomer *newAccount = new BankCustomer(customerCount, customerName, initialBalance);
-        Accounts.push_back(newAccount);
+        uint64_t lsn;
+        size_t offset;
+        {
+            lock_guard<mutex> lock(sequenceMutex);
+            lsn = log ? log->append(record) : 0;
+            offset = ledger.append(entries.size());
+        }
+        for (const auto &entry : entries)
+        {
+            post(offset++, LedgerRecord(entry.accountId, entry.type, entry.kind, entry.memo,
+                                        Money::fromMinorUnits(record.amount), record.timestamp));
+        }
+        return lsn;
+    }
 
-        // Record initial deposit transaction
-        if (initialBalance > 0)
+    void waitDurable(uint64_t lsn)
+    {
+        if (log && lsn > 0 && log->waitsForDurable())
         {
-            Transaction trans(nextTransactionId++, customerCount, CREDIT, initialBalance, "Initial deposit");
-            transactions.push_back(trans);
+            log->waitDurable(lsn);
         }
+    }
 
-        return newAccount;
+    // Re-apply one logged mutation with its original timestamp (single-threaded replay).
+    // Returns false, applying nothing, for a record that does not fit the state
+    // rebuilt so far: an unknown account or a debit the balance cannot cover.
+    bool applyLogRecord(const WalRecord &record)
+    {
+        Money amount = Money::fromMinorUnits(record.amount);
+        time_t timestamp = record.timestamp;
+        BankCustomer *account = findAccount(record.accountId);
+        switch (record.type)
+        {
+        case WAL_CREATE_ACCOUNT:
+            addAccountLedger(static_cast<int>(Accounts.size()) + 1);
+            Accounts.emplace_back(static_cast<int>(Accounts.size()) + 1, string(record.text), amount);
+            if (amount > Money())
+            {
+                post(LedgerRecord(static_cast<int>(Accounts.size()), CREDIT, DESC_INITIAL_DEPOSIT, 0, amount, timestamp));
+            }
+            break;
+        case WAL_TOP_UP:
+            if (!account)
+            {
+                return false;
+            }
+            account->addBalance(amount);
+            post(LedgerRecord(record.accountId, CREDIT, DESC_TOP_UP, 0, amount, timestamp));
+            break;
+        case WAL_WITHDRAW:
+            if (!account || !account->withdrawBalance(amount))
+            {
+                return false;
+            }
+            post(LedgerRecord(record.accountId, DEBIT, DESC_WITHDRAWAL, 0, amount, timestamp));
+            break;
+        case WAL_RECORD_TRANSACTION:
+            post(LedgerRecord(record.accountId, static_cast<TransactionType>(record.transactionType),
+                             DESC_CUSTOM, ledger.intern(record.text), amount, timestamp));
+            break;
+        case WAL_TRANSFER:
+        {
+            BankCustomer *counterparty = findAccount(record.counterpartyId);
+            if (!account || !counterparty || !account->withdrawBalance(amount))
+            {
+                return false;
+            }
+            uint32_t memo = ledger.intern(record.text);
+            counterparty->addBalance(amount);
+            post(LedgerRecord(record.accountId, DEBIT, DESC_PURCHASE, memo, amount, timestamp));
+            post(LedgerRecord(record.counterpartyId, CREDIT, DESC_SALE, memo, amount, timestamp));
+            break;
+        }
+        }
+        return true;
     }
 
-    // Find account by ID
-    BankCustomer *findAccount(int accountId)
+    TransactionView transactionsSince(int accountId, time_t startTime) const
+    {
+        if (accountId < 1 || static_cast<size_t>(accountId) > Accounts.size())
+        {
+            return TransactionView();
+        }
+        mutex &stripeLock = accountLock(accountId);
+        lock_guard<mutex> lock(stripeLock);
+        const AccountLedger &account = accountLedgers[accountId - 1];
+        return TransactionView(stripeLock, ledger, account, accountId, account.postings.lowerBound(startTime),
+                               account.postings.size());
+    }
+
+public:
+    Bank(const string &name) : name(name), log(nullptr) {}
+
+    string getName() const { return name; }
+
+    // Rebuild state from a write-ahead log; call before attachLog on a fresh Bank.
+    // Returns the number of records read; rejected, if given, receives how many
+    // of them did not fit the rebuilt state and were skipped.
+    size_t replayLog(const string &path, size_t *rejected = nullptr)
+    {
+        size_t skipped = 0;
+        size_t records = WriteAheadLog::replay(path, [&](const WalRecord &record)
+                                               { skipped += !applyLogRecord(record); });
+        if (rejected)
+        {
+            *rejected = skipped;
+        }
+        return records;
+    }
+
+    // Log every following mutation to the given write-ahead log.
+    // Call while no other thread is using the bank.
+    void attachLog(WriteAheadLog *writeAheadLog)
+    {
+        log = writeAheadLog;
+    }
+
+    // True when the attached write-ahead log has failed to write, so recent
+    // mutations may not survive a restart
+    bool logFailed() const { return log && log->hasFailed(); }
+
+    // Most accounts the bank can hold; account records live in a fixed-capacity slab
+    static constexpr size_t MaxAccounts = Slab<BankCustomer>::capacity();
+
+    // Create new bank account; nullptr once MaxAccounts accounts exist
+    BankCustomer *createAccount(const string &customerName, Money initialBalance)
     {
-        for (auto account : Accounts)
+        time_t now = time(nullptr);
+        uint64_t lsn;
+        BankCustomer *newAccount;
         {
-            if (account->getId() == accountId)
+            // ids follow creation order, so creation and its log record happen under one lock
+            lock_guard<mutex> lock(accountsMutex);
+            if (Accounts.size() >= MaxAccounts)
+            {
+                return nullptr;
+            }
+            int accountId = static_cast<int>(Accounts.size()) + 1;
+            lock_guard<mutex> stripeLock(accountLock(accountId));
+            addAccountLedger(accountId);
+            WalRecord record = {WAL_CREATE_ACCOUNT, accountId, CREDIT, initialBalance.minorUnits(), now, customerName};
+            if (initialBalance > Money())
             {
-                return account;
+                lsn = recordMutation(record, {{accountId, CREDIT, DESC_INITIAL_DEPOSIT}});
             }
+            else
+            {
+                lsn = recordMutation(record, {});
+            }
+            newAccount = &Accounts.emplace_back(accountId, customerName, initialBalance);
+        }
+        waitDurable(lsn);
+        return newAccount;
+    }
+
+    // Find account by ID (ids are dense, so this is a direct slot lookup)
+    BankCustomer *findAccount(int accountId)
+    {
+        if (accountId < 1 || static_cast<size_t>(accountId) > Accounts.size())
+        {
+            return nullptr;
         }
-        return nullptr;
+        return &Accounts[accountId - 1];
     }
 
     // Top-up balance
-    bool topUp(int accountId, double amount)
+    bool topUp(int accountId, Money amount)
     {
         BankCustomer *account = findAccount(accountId);
-        if (account && amount > 0)
+        if (!account || amount <= Money())
         {
+            return false;
+        }
+        uint64_t lsn;
+        {
+            lock_guard<mutex> lock(accountLock(accountId));
             account->addBalance(amount);
-            Transaction trans(nextTransactionId++, accountId, CREDIT, amount, "Top-up");
-            transactions.push_back(trans);
-            return true;
+            lsn = recordMutation({WAL_TOP_UP, accountId, CREDIT, amount.minorUnits(), time(nullptr), ""},
+                                 {{accountId, CREDIT, DESC_TOP_UP}});
         }
-        return false;
+        waitDurable(lsn);
+        return true;
     }
 
     // Withdraw balance
-    bool withdraw(int accountId, double amount)
+    bool withdraw(int accountId, Money amount)
     {
         BankCustomer *account = findAccount(accountId);
-        if (account && account->withdrawBalance(amount))
+        if (!account)
+        {
+            return false;
+        }
+        uint64_t lsn;
         {
-            Transaction trans(nextTransactionId++, accountId, DEBIT, amount, "Withdrawal");
-            transactions.push_back(trans);
-            return true;
+            lock_guard<mutex> lock(accountLock(accountId));
+            if (!account->withdrawBalance(amount))
+            {
+                return false;
+            }
+            lsn = recordMutation({WAL_WITHDRAW, accountId, DEBIT, amount.minorUnits(), time(nullptr), ""},
+                                 {{accountId, DEBIT, DESC_WITHDRAWAL}});
         }
-        return false;
+        waitDurable(lsn);
+        return true;
     }
 
-    // Record a transaction (for purchases)
-    void recordTransaction(int accountId, TransactionType type, double amount, const string &description)
+    // Record a transaction with a free-form description
+    void recordTransaction(int accountId, TransactionType type, Money amount, const string &description)
     {
-        Transaction trans(nextTransactionId++, accountId, type, amount, description);
-        transactions.push_back(trans);
+        if (!findAccount(accountId))
+        {
+            return;
+        }
+        // the memo pool locks itself, so interning needs no stripe
+        uint32_t memo = ledger.intern(description);
+        uint64_t lsn;
+        {
+            lock_guard<mutex> lock(accountLock(accountId));
+            lsn = recordMutation({WAL_RECORD_TRANSACTION, accountId, static_cast<uint8_t>(type),
+                                  amount.minorUnits(), time(nullptr), description},
+                                 {{accountId, type, DESC_CUSTOM, memo}});
+        }
+        waitDurable(lsn);
     }
 
-    // Get transactions for last 7 days
-    vector<Transaction> getTransactionsLast7Days(int accountId) const
+    // Move amount from one account to another as a single unit: both balance legs
+    // and both ledger entries ("Purchase: memo" / "Sale: memo") share one log record.
+    // The memo is interned once and shared by both entries.
+    // Both accounts' lock stripes are held, taken in stripe order, across the
+    // balance legs and the sequence number of the shared record.
+    bool transfer(int fromId, int toId, Money amount, const string &memo)
     {
-        vector<Transaction> recentTrans;
-        time_t now = time(nullptr);
-        time_t sevenDaysAgo = now - (7 * 24 * 60 * 60);
+        BankCustomer *from = findAccount(fromId);
+        BankCustomer *to = findAccount(toId);
+        if (!from || !to || amount <= Money())
+        {
+            return false;
+        }
 
-        for (const auto &trans : transactions)
+        size_t first = stripeOf(fromId);
+        size_t second = stripeOf(toId);
+        if (first > second)
         {
-            if (trans.getCustomerId() == accountId && trans.getTimestamp() >= sevenDaysAgo)
+            swap(first, second);
+        }
+
+        uint32_t memoId = ledger.intern(memo);
+        uint64_t lsn;
+        {
+            lock_guard<mutex> firstLock(stripes[first].mtx);
+            unique_lock<mutex> secondLock;
+            if (second != first)
             {
-                recentTrans.push_back(trans);
+                secondLock = unique_lock<mutex>(stripes[second].mtx);
             }
+
+            if (!from->withdrawBalance(amount))
+            {
+                return false;
+            }
+            to->addBalance(amount);
+
+            WalRecord record = {WAL_TRANSFER, fromId, DEBIT, amount.minorUnits(), time(nullptr), memo};
+            record.counterpartyId = toId;
+            lsn = recordMutation(record, {{fromId, DEBIT, DESC_PURCHASE, memoId}, {toId, CREDIT, DESC_SALE, memoId}});
         }
-        return recentTrans;
+        waitDurable(lsn);
+        return true;
     }
 
-    // Get transactions for today
-    vector<Transaction> getTransactionsToday(int accountId) const
+    // Get transactions for last 7 days
+    TransactionView getTransactionsLast7Days(int accountId) const
     {
-        vector<Transaction> todayTrans;
         time_t now = time(nullptr);
-        time_t startOfDay = now - (now % 86400);
+        time_t sevenDaysAgo = now - (7 * 24 * 60 * 60);
+        return transactionsSince(accountId, sevenDaysAgo);
+    }
 
-        for (const auto &trans : transactions)
-        {
-            if (trans.getCustomerId() == accountId && trans.getTimestamp() >= startOfDay)
-            {
-                todayTrans.push_back(trans);
-            }
-        }
-        return todayTrans;
+    // Get transactions for today
+    TransactionView getTransactionsToday(int accountId) const
+    {
+        time_t now = time(nullptr);
+        return transactionsSince(accountId, localDayStart(localDay(now)));
     }
 
     // Get transactions for this month
-    vector<Transaction> getTransactionsThisMonth(int accountId) const
+    TransactionView getTransactionsThisMonth(int accountId) const
     {
-        vector<Transaction> monthTrans;
         time_t now = time(nullptr);
         struct tm *timeInfo = localtime(&now);
         timeInfo->tm_mday = 1;
@@ -142,44 +486,44 @@ public:
         timeInfo->tm_min = 0;
         timeInfo->tm_sec = 0;
         time_t startOfMonth = mktime(timeInfo);
-
-        for (const auto &trans : transactions)
-        {
-            if (trans.getCustomerId() == accountId && trans.getTimestamp() >= startOfMonth)
-            {
-                monthTrans.push_back(trans);
-            }
-        }
-        return monthTrans;
+        return transactionsSince(accountId, startOfMonth);
     }
 
     // List all customers
-    vector<BankCustomer *> getAllCustomers() const
+    const Slab<BankCustomer> &getAllCustomers() const
     {
         return Accounts;
     }
 
-    // List dormant accounts (no activity for 30+ days)
-    vector<BankCustomer *> getDormantAccounts() const
+    // List dormant accounts (no activity for the given number of days), least recently active first
+    vector<const BankCustomer *> getDormantAccounts(int days = 30) const
     {
-        vector<BankCustomer *> dormant;
         time_t now = time(nullptr);
-        time_t thirtyDaysAgo = now - (30 * 24 * 60 * 60);
+        time_t cutoff = now - static_cast<time_t>(days) * 24 * 60 * 60;
 
-        for (auto account : Accounts)
+        // each stripe's index is in activity order; merge the dormant prefixes
+        vector<pair<time_t, int>> entries;
+        for (auto &stripe : stripes)
         {
-            bool hasRecentActivity = false;
-            for (const auto &trans : transactions)
+            lock_guard<mutex> lock(stripe.mtx);
+            for (const auto &entry : stripe.activityIndex)
             {
-                if (trans.getCustomerId() == account->getId() && trans.getTimestamp() >= thirtyDaysAgo)
+                if (entry.first >= cutoff)
                 {
-                    hasRecentActivity = true;
                     break;
                 }
+                entries.push_back(entry);
             }
-            if (!hasRecentActivity)
+        }
+        sort(entries.begin(), entries.end());
+
+        vector<const BankCustomer *> dormant;
+        for (const auto &entry : entries)
+        {
+            // an account being created is indexed just before it is published
+            if (static_cast<size_t>(entry.second) <= Accounts.size())
             {
-                dormant.push_back(account);
+                dormant.push_back(&Accounts[entry.second - 1]);
             }
         }
         return dormant;
@@ -188,58 +532,54 @@ public:
     // Get top N active users by transaction count today
     vector<pair<int, int>> getTopNActiveUsersToday(int n) const
     {
+        size_t count = static_cast<size_t>(max(n, 0));
         time_t now = time(nullptr);
-        time_t startOfDay = now - (now % 86400);
-
-        std::map<int, int> transactionCounts;
-        for (const auto &trans : transactions)
-        {
-            if (trans.getTimestamp() >= startOfDay)
-            {
-                transactionCounts[trans.getCustomerId()]++;
-            }
-        }
-
-        vector<pair<int, int>> sortedUsers(transactionCounts.begin(), transactionCounts.end());
-        sort(sortedUsers.begin(), sortedUsers.end(),
-             [](const pair<int, int> &a, const pair<int, int> &b)
-             {
-                 return a.second > b.second;
-             });
 
-        if (sortedUsers.size() > (size_t)n)
+        // every account counts on exactly one stripe, so the overall top n is
+        // among the stripes' own top n
+        vector<pair<int, int>> top;
+        for (auto &stripe : stripes)
         {
-            sortedUsers.resize(n);
+            lock_guard<mutex> lock(stripe.mtx);
+            vector<pair<int, int>> stripeTop = stripe.todayActivity.top(count, now);
+            top.insert(top.end(), stripeTop.begin(), stripeTop.end());
         }
-
-        return sortedUsers;
+        stable_sort(top.begin(), top.end(), [](const pair<int, int> &a, const pair<int, int> &b)
+                    { return a.second > b.second; });
+        top.resize(min(count, top.size()));
+        return top;
     }
 
     // Calculate cash flow (credit - debit)
-    pair<double, double> getCashFlow(int accountId, time_t startTime) const
+    // Whole days come from the daily buckets; only a partial first day reads the ledger
+    pair<Money, Money> getCashFlow(int accountId, time_t startTime) const
     {
-        double credit = 0.0;
-        double debit = 0.0;
+        if (accountId < 1 || static_cast<size_t>(accountId) > Accounts.size())
+        {
+            return {Money(), Money()};
+        }
 
-        for (const auto &trans : transactions)
+        lock_guard<mutex> lock(accountLock(accountId));
+        const AccountLedger &account = accountLedgers[accountId - 1];
+        const DailyCashFlow &flow = account.cashFlow;
+        time_t startDay = localDay(startTime);
+        if (startTime == localDayStart(startDay))
         {
-            if (trans.getCustomerId() == accountId && trans.getTimestamp() >= startTime)
-            {
-                if (trans.getType() == CREDIT)
-                {
-                    credit += trans.getAmount();
-                }
-                else
-                {
-                    debit += trans.getAmount();
-                }
-            }
+            return {flow.credit.sumFrom(startDay), flow.debit.sumFrom(startDay)};
         }
 
+        // Scan only the account's own rows of the partial first day
+        time_t nextDay = localDayStart(startDay + 1);
+        const AccountPostings &postings = account.postings;
+        LedgerTotals partial = postings.sum(postings.lowerBound(startTime), postings.lowerBound(nextDay), startTime, nextDay);
+
+        Money credit = flow.credit.sumFrom(startDay + 1) + partial.credit;
+        Money debit = flow.debit.sumFrom(startDay + 1) + partial.debit;
+
         return {credit, debit};
     }
 
-    int getCustomerCount() const { return customerCount; }
+    int getCustomerCount() const { return static_cast<int>(Accounts.size()); }
 };
 
 #endif // BANK_H
\ No newline at end of file
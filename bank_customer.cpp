@@ -10,29 +10,33 @@ int BankCustomer::getId() const {
     return this->id ;
 }
 
-double BankCustomer::getBalance() const {
-    return this->balance;
+Money BankCustomer::getBalance() const {
+    return Money::fromMinorUnits(this->balance.load());
 }
 
-void BankCustomer::setBalance(double amount) {
-    this->balance = amount;
+void BankCustomer::setBalance(Money amount) {
+    this->balance.store(amount.minorUnits());
 }
 
-void BankCustomer::addBalance(double amount) {
-    this->balance += amount;
+void BankCustomer::addBalance(Money amount) {
+    int64_t current = this->balance.load();
+    while (!this->balance.compare_exchange_weak(current, (Money::fromMinorUnits(current) + amount).minorUnits())) {
+    }
 }
 
-bool BankCustomer::withdrawBalance(double amount){
-    if (amount > this->balance) {
-        std::cout << "Rejected: Insufficient funds!" << std::endl;
-        return false;
-    }
-    this->balance -= amount;
+bool BankCustomer::withdrawBalance(Money amount){
+    int64_t current = this->balance.load();
+    do {
+        if (amount > Money::fromMinorUnits(current)) {
+            std::cout << "Rejected: Insufficient funds!" << std::endl;
+            return false;
+        }
+    } while (!this->balance.compare_exchange_weak(current, (Money::fromMinorUnits(current) - amount).minorUnits()));
     return true;
 }
 
 void BankCustomer::printInfo() const {
     std::cout << "Customer Name: " << this->name << std::endl;
     std::cout << "Customer ID: " << this->id << std::endl;
-    std::cout << "Balance: $" << this->balance << std::endl;
+    std::cout << "Balance: $" << getBalance() << std::endl;
 }
\ No newline at end of file
@@ -1,7 +1,9 @@
 #ifndef BANK_CUSTOMER_H
 #define BANK_CUSTOMER_H
 
+#include <atomic>
 #include <string>
+#include "money.h"
 
 using namespace std;
 
@@ -9,24 +11,20 @@ class BankCustomer {
 private:
     int id;
     string name;
-    double balance;
+    atomic<int64_t> balance; // minor units, updated lock-free with CAS
 
 public:
-    BankCustomer(int id, const string& name, double balance) : id(id), name(name), balance(balance) {
-        this->id = id;
-        this->name = name;
-        this->balance = balance;
-    }
+    BankCustomer(int id, const string& name, Money balance) : id(id), name(name), balance(balance.minorUnits()) {}
 
     int getId() const;
     string getName() const;
-    double getBalance() const;
+    Money getBalance() const;
 
     void printInfo() const;
     void setName(const string& name);
-    void setBalance(double balance);
-    void addBalance(double amout);
-    bool withdrawBalance(double amout);
+    void setBalance(Money balance);
+    void addBalance(Money amout);
+    bool withdrawBalance(Money amout);
 };
 
 #endif // BANK_CUSTOMER_H
\ No newline at end of file
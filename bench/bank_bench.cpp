@@ -0,0 +1,89 @@
+// Top-up/withdraw throughput by thread count: the Bank behind one global
+// mutex (how a single-threaded bank has to be shared) against the
+// concurrent Bank used directly. No write-ahead log is attached.
+// Usage: bank_bench [operations per thread] [accounts] [max threads]
+
+#include "bank.h"
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+namespace
+{
+    // Run ops top-ups and withdrawals per thread; returns operations per second
+    template <typename Operation>
+    double measure(size_t threads, size_t ops, int accounts, Operation operation)
+    {
+        vector<thread> workers;
+        auto start = chrono::steady_clock::now();
+        for (size_t t = 0; t < threads; t++)
+        {
+            workers.emplace_back([&, t]
+                                 {
+                                     mt19937 rng(static_cast<unsigned>(t) + 1);
+                                     uniform_int_distribution<int> account(1, accounts);
+                                     for (size_t i = 0; i < ops; i++)
+                                     {
+                                         operation(account(rng), i % 2 == 0);
+                                     }
+                                 });
+        }
+        for (auto &worker : workers)
+        {
+            worker.join();
+        }
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        return static_cast<double>(threads * ops) / seconds;
+    }
+
+    void populate(Bank &bank, int accounts)
+    {
+        for (int i = 0; i < accounts; i++)
+        {
+            bank.createAccount("bench", Money::fromMinorUnits(1000000000));
+        }
+    }
+}
+
+int main(int argc, char **argv)
+{
+    size_t ops = argc > 1 ? strtoull(argv[1], nullptr, 10) : 200000;
+    int accounts = argc > 2 ? atoi(argv[2]) : 4096;
+    size_t maxThreads = argc > 3 ? strtoull(argv[3], nullptr, 10) : max(1u, thread::hardware_concurrency());
+    if (ops == 0 || accounts <= 0 || maxThreads == 0)
+    {
+        cerr << "usage: bank_bench [operations per thread] [accounts] [max threads]" << endl;
+        return 1;
+    }
+
+    Money amount = Money::fromMinorUnits(100);
+
+    cout << "threads  locked ops/s  concurrent ops/s" << endl;
+    for (size_t threads = 1; threads <= maxThreads; threads *= 2)
+    {
+        Bank lockedBank("locked");
+        populate(lockedBank, accounts);
+        mutex bankMutex;
+        double locked = measure(threads, ops, accounts, [&](int id, bool credit)
+                                {
+                                    lock_guard<mutex> lock(bankMutex);
+                                    credit ? lockedBank.topUp(id, amount) : lockedBank.withdraw(id, amount);
+                                });
+
+        Bank concurrentBank("concurrent");
+        populate(concurrentBank, accounts);
+        double concurrent = measure(threads, ops, accounts, [&](int id, bool credit)
+                                    {
+                                        credit ? concurrentBank.topUp(id, amount) : concurrentBank.withdraw(id, amount);
+                                    });
+
+        cout << threads << "  " << static_cast<uint64_t>(locked) << "  " << static_cast<uint64_t>(concurrent) << endl;
+    }
+    return 0;
+}
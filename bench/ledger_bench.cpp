@@ -0,0 +1,113 @@
+// Cash flow of every account over a time window, each account reading only
+// its own rows: per-account offsets into a vector<Transaction> (the layout
+// before per-account columns) against per-account columns summed by each
+// kernel the machine supports.
+// Usage: ledger_bench [rows] [accounts]
+
+#include "ledger.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using namespace std;
+
+namespace
+{
+    double millisecondsSince(chrono::steady_clock::time_point start)
+    {
+        return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    }
+}
+
+int main(int argc, char **argv)
+{
+    size_t rows = argc > 1 ? strtoull(argv[1], nullptr, 10) : 1000000;
+    int accounts = argc > 2 ? atoi(argv[2]) : 200;
+    if (rows == 0 || accounts <= 0)
+    {
+        cerr << "usage: ledger_bench [rows] [accounts]" << endl;
+        return 1;
+    }
+
+    mt19937_64 rng(42);
+    uniform_int_distribution<int> customer(1, accounts);
+    uniform_int_distribution<int64_t> cents(1, 100000);
+    time_t start = time(nullptr) - 30 * 86400;
+    time_t step = max<time_t>(1, 30 * 86400 / static_cast<time_t>(rows));
+
+    vector<Transaction> rowsAoS;
+    vector<vector<size_t>> accountOffsets(static_cast<size_t>(accounts)); // rows of each account into rowsAoS
+    vector<AccountPostings> postings(static_cast<size_t>(accounts));
+    rowsAoS.reserve(rows);
+    for (size_t i = 0; i < rows; i++)
+    {
+        int id = customer(rng);
+        TransactionType type = rng() % 2 ? CREDIT : DEBIT;
+        Money amount = Money::fromMinorUnits(cents(rng));
+        time_t timestamp = start + static_cast<time_t>(i) * step;
+
+        rowsAoS.emplace_back(static_cast<int>(i) + 1, id, type, amount, "Purchase: benchmark item");
+        rowsAoS.back().setTimestamp(timestamp);
+        accountOffsets[static_cast<size_t>(id - 1)].push_back(i);
+        postings[static_cast<size_t>(id - 1)].append(i, LedgerRecord(id, type, DESC_PURCHASE, 0, amount, timestamp));
+    }
+
+    // cash flow of every account over the last two weeks
+    time_t since = start + 16 * 86400 + 1234;
+    time_t until = start + 31 * 86400;
+
+    auto aosStart = chrono::steady_clock::now();
+    int64_t aosCheck = 0;
+    for (const auto &offsets : accountOffsets)
+    {
+        auto first = partition_point(offsets.begin(), offsets.end(),
+                                     [&](size_t offset)
+                                     {
+                                         return rowsAoS[offset].getTimestamp() < since;
+                                     });
+        Money credit, debit;
+        for (auto it = first; it != offsets.end(); ++it)
+        {
+            const Transaction &trans = rowsAoS[*it];
+            if (trans.getTimestamp() >= until)
+            {
+                break;
+            }
+            (trans.getType() == CREDIT ? credit : debit) += trans.getAmount();
+        }
+        aosCheck += credit.minorUnits() - debit.minorUnits();
+    }
+    double aosMs = millisecondsSince(aosStart);
+
+    cout << rows << " rows, " << accounts << " accounts" << endl;
+    cout << "offsets into Transaction array: " << aosMs << " ms" << endl;
+    int status = 0;
+    for (LedgerKernel kernel : {KERNEL_SCALAR, KERNEL_SSE42, KERNEL_AVX2})
+    {
+        if (kernel > AccountPostings::bestKernel())
+        {
+            cout << "columns, " << AccountPostings::kernelName(kernel) << ": not supported here" << endl;
+            continue;
+        }
+
+        auto columnStart = chrono::steady_clock::now();
+        int64_t columnCheck = 0;
+        for (const auto &account : postings)
+        {
+            LedgerTotals totals = account.sum(account.lowerBound(since), account.size(), since, until, kernel);
+            columnCheck += totals.credit.minorUnits() - totals.debit.minorUnits();
+        }
+        double columnMs = millisecondsSince(columnStart);
+
+        cout << "columns, " << AccountPostings::kernelName(kernel) << ": " << columnMs << " ms" << endl;
+        if (aosCheck != columnCheck)
+        {
+            cerr << "totals differ: " << aosCheck << " vs " << columnCheck << endl;
+            status = 1;
+        }
+    }
+    return status;
+}
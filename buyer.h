@@ -16,6 +16,8 @@ private:
 public:
     Buyer(int id, const string& name, BankCustomer &account0)
         : id(id), name(name), account(account0) {}
+    // Seller extends Buyer; deleting one through a Buyer pointer must run ~Seller
+    virtual ~Buyer() = default;
 
     int getId() const { return id; }
     string getName() const { return name; }
@@ -0,0 +1,32 @@
+#ifndef CALENDAR_H
+#define CALENDAR_H
+
+#include <ctime>
+
+using namespace std;
+
+// Day numbers for every day-bucketed index: days since 1970-01-01 in the
+// local time zone. Month reports take their boundaries from localtime/mktime,
+// so local days make a month (or "today") start exactly on a bucket edge.
+inline time_t localDay(time_t timestamp)
+{
+    struct tm local;
+    localtime_r(&timestamp, &local);
+    time_t shifted = timestamp + local.tm_gmtoff;
+    return shifted >= 0 ? shifted / 86400 : (shifted - 86399) / 86400;
+}
+
+// Local midnight that starts the given local day
+inline time_t localDayStart(time_t day)
+{
+    time_t utcMidnight = day * 86400;
+    struct tm date;
+    gmtime_r(&utcMidnight, &date);
+    date.tm_hour = 0;
+    date.tm_min = 0;
+    date.tm_sec = 0;
+    date.tm_isdst = -1;
+    return mktime(&date);
+}
+
+#endif // CALENDAR_H
@@ -0,0 +1,118 @@
+#ifndef DAILY_FENWICK_H
+#define DAILY_FENWICK_H
+
+#include <algorithm>
+#include <cstddef>
+#include <ctime>
+#include <vector>
+
+using namespace std;
+
+// Fenwick tree over consecutive day buckets (day = localDay(timestamp)).
+// Buckets start at the first day added and grow as later days arrive;
+// point updates and "sum since day" queries are both O(log days).
+template <typename T>
+class DailyFenwick
+{
+private:
+    time_t firstDay;
+    vector<T> tree; // 1-based, tree[0] is unused
+    T total;
+
+    static size_t lowBit(size_t i) { return i & (~i + 1); }
+
+    // Sum of the first count buckets
+    T prefix(size_t count) const
+    {
+        T sum{};
+        for (size_t i = count; i > 0; i -= lowBit(i))
+        {
+            sum += tree[i];
+        }
+        return sum;
+    }
+
+    // Append empty buckets until there are at least count of them
+    void grow(size_t count)
+    {
+        size_t target = max(count, 2 * (tree.size() - 1));
+        tree.reserve(target + 1);
+        while (tree.size() <= target)
+        {
+            size_t i = tree.size();
+            tree.push_back(prefix(i - 1) - prefix(i - lowBit(i)));
+        }
+    }
+
+    // Make day the first bucket, re-adding existing buckets after it
+    void rebase(time_t day)
+    {
+        size_t count = tree.size() - 1;
+        vector<T> buckets(count);
+        for (size_t i = 0; i < count; i++)
+        {
+            buckets[i] = prefix(i + 1) - prefix(i);
+        }
+
+        size_t shift = static_cast<size_t>(firstDay - day);
+        tree.assign(1, T{});
+        firstDay = day;
+        total = T{};
+        grow(count + shift);
+        for (size_t i = 0; i < count; i++)
+        {
+            addAt(shift + i, buckets[i]);
+        }
+    }
+
+    void addAt(size_t bucket, T value)
+    {
+        for (size_t i = bucket + 1; i < tree.size(); i += lowBit(i))
+        {
+            tree[i] += value;
+        }
+        total += value;
+    }
+
+public:
+    DailyFenwick() : firstDay(0), tree(1), total() {}
+
+    bool empty() const { return tree.size() == 1; }
+
+    void add(time_t day, T value)
+    {
+        if (empty())
+        {
+            firstDay = day;
+        }
+        else if (day < firstDay)
+        {
+            rebase(day);
+        }
+
+        size_t bucket = static_cast<size_t>(day - firstDay);
+        if (bucket + 1 >= tree.size())
+        {
+            grow(bucket + 1);
+        }
+        addAt(bucket, value);
+    }
+
+    // Sum of all buckets from day onwards
+    T sumFrom(time_t day) const
+    {
+        if (empty() || day <= firstDay)
+        {
+            return total;
+        }
+
+        size_t before = static_cast<size_t>(day - firstDay);
+        if (before >= tree.size() - 1)
+        {
+            return T{};
+        }
+        return total - prefix(before);
+    }
+};
+
+#endif // DAILY_FENWICK_H
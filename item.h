@@ -2,6 +2,7 @@
 #define ITEM_H
 
 #include <string>
+#include "money.h"
 
 using namespace std;
 
@@ -10,11 +11,11 @@ private:
     int id;
     std::string name;
     int quantity;
-    double price;
+    Money price;
     bool idDisplay;
 
 public:
-    Item(int id, const std::string& name, int quantity, double price)
+    Item(int id, const std::string& name, int quantity, Money price)
         : id(id), name(name), quantity(quantity), price(price) {
             idDisplay = false; // Default value for idDisplay
         }
@@ -23,7 +24,7 @@ public:
     int getId() const { return id; }
     const std::string& getName() const { return name; }
     int getQuantity() const { return quantity; }
-    double getPrice() const { return price; }
+    Money getPrice() const { return price; }
     Item *getItem() {
         return this; // Returns a pointer to the current item
     }
@@ -32,10 +33,10 @@ public:
     void setId(int newId) { id = newId; }
     void setName(const std::string& newName) { name = newName; }
     void setQuantity(int newQuantity) { quantity = newQuantity; }
-    void setPrice(double newPrice) { price = newPrice; }
+    void setPrice(Money newPrice) { price = newPrice; }
     void setDisplay(bool display) { idDisplay = display; }
 
-    void alterItemById(int itemId, const std::string& newName, int newQuantity, double newPrice) {
+    void alterItemById(int itemId, const std::string& newName, int newQuantity, Money newPrice) {
         if (id == itemId) {
             name = newName;
             quantity = newQuantity;
@@ -43,7 +44,7 @@ public:
         }
     }
 
-    void updatePriceQuantity(int itemId, double newPrice, int newQuantity) {
+    void updatePriceQuantity(int itemId, Money newPrice, int newQuantity) {
         if (id == itemId) {
             price = newPrice;
             quantity = newQuantity;
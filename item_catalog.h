@@ -0,0 +1,100 @@
+#ifndef ITEM_CATALOG_H
+#define ITEM_CATALOG_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "string_pool.h"
+
+using namespace std;
+
+class Seller;
+
+// Marketplace item index, owned by the Store and shared with its sellers:
+// item id -> current name and the seller (and slot in that seller's items)
+// listing it. Orders keep only the item id and look the name up when it is
+// displayed; browsing and payment find an item without scanning every
+// seller. Item ids are small and dense, so entries are a vector indexed by
+// id. Like Store, this is not safe to modify from several threads.
+class ItemCatalog
+{
+private:
+    struct Entry
+    {
+        uint32_t name = 0;        // pool id, 0 when unknown
+        uint32_t slot = 0;        // index in seller's items
+        Seller *seller = nullptr; // nullptr when no seller lists the item
+    };
+
+    StringPool names;
+    vector<Entry> entries; // item id N -> entry at N
+
+    Entry *entryFor(int itemId)
+    {
+        if (itemId < 0)
+        {
+            return nullptr;
+        }
+        if (static_cast<size_t>(itemId) >= entries.size())
+        {
+            entries.resize(static_cast<size_t>(itemId) + 1);
+        }
+        return &entries[itemId];
+    }
+
+    const Entry *find(int itemId) const
+    {
+        bool known = itemId >= 0 && static_cast<size_t>(itemId) < entries.size();
+        return known ? &entries[itemId] : nullptr;
+    }
+
+public:
+    void setName(int itemId, string_view name)
+    {
+        if (Entry *entry = entryFor(itemId))
+        {
+            entry->name = names.intern(name);
+        }
+    }
+
+    const string &getName(int itemId) const
+    {
+        const Entry *entry = find(itemId);
+        return names.get(entry ? entry->name : 0);
+    }
+
+    // Record that seller holds itemId at slot in its items
+    void place(int itemId, Seller *seller, size_t slot)
+    {
+        if (Entry *entry = entryFor(itemId))
+        {
+            entry->seller = seller;
+            entry->slot = static_cast<uint32_t>(slot);
+        }
+    }
+
+    // Drop the listing of itemId if seller still owns it
+    void release(int itemId, const Seller *seller)
+    {
+        const Entry *found = find(itemId);
+        if (found && found->seller == seller)
+        {
+            entries[itemId].seller = nullptr;
+        }
+    }
+
+    // Seller listing itemId, or nullptr; slot is set to its index in that seller's items
+    Seller *findSeller(int itemId, size_t &slot) const
+    {
+        const Entry *entry = find(itemId);
+        if (!entry || !entry->seller)
+        {
+            return nullptr;
+        }
+        slot = entry->slot;
+        return entry->seller;
+    }
+};
+
+#endif // ITEM_CATALOG_H
@@ -0,0 +1,348 @@
+#ifndef LEDGER_H
+#define LEDGER_H
+
+#include "transaction.h"
+#include "money.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <ctime>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+#include "string_pool.h"
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#include <immintrin.h>
+#define LEDGER_X86_KERNELS 1
+#endif
+
+using namespace std;
+
+// What a ledger row's description says. PURCHASE and SALE rows carry the
+// interned item name as their memo, CUSTOM rows the whole description.
+enum DescriptionKind : uint8_t
+{
+    DESC_INITIAL_DEPOSIT,
+    DESC_TOP_UP,
+    DESC_WITHDRAWAL,
+    DESC_PURCHASE,
+    DESC_SALE,
+    DESC_CUSTOM
+};
+
+// One ledger row packed into 24 bytes with no heap data.
+// The transaction id is implied by the row's offset in the ledger.
+struct LedgerRecord
+{
+    int64_t amount; // Money minor units
+    int32_t customerId;
+    uint32_t timestamp; // seconds since RecordEpoch
+    uint32_t memo;      // StringPool id, 0 when the kind needs no text
+    uint8_t type;       // TransactionType
+    uint8_t kind;       // DescriptionKind
+
+    LedgerRecord() = default;
+    LedgerRecord(int customerId, TransactionType type, DescriptionKind kind, uint32_t memo,
+                 Money amount, time_t timestamp)
+        : amount(amount.minorUnits()), customerId(customerId), timestamp(toRecordTime(timestamp)),
+          memo(memo), type(static_cast<uint8_t>(type)), kind(kind) {}
+
+    TransactionType getType() const { return static_cast<TransactionType>(type); }
+    Money getAmount() const { return Money::fromMinorUnits(amount); }
+    time_t getTimestamp() const { return RecordEpoch + timestamp; }
+};
+
+static_assert(sizeof(LedgerRecord) == 24, "LedgerRecord should stay 24 bytes");
+static_assert(is_trivially_copyable_v<LedgerRecord>);
+
+// Result of a filter-and-sum scan over the ledger
+struct LedgerTotals
+{
+    Money credit;
+    Money debit;
+    size_t count = 0;
+};
+
+// Append-only bank ledger. The rows themselves are stored once, per account,
+// in AccountPostings; the ledger numbers them (a row's offset is its
+// transaction id - 1) and owns the interned memos their descriptions use.
+// Descriptions are stored as a kind plus an interned memo and only rendered
+// when a row is materialized. Numbering and interning are thread-safe.
+class Ledger
+{
+private:
+    atomic<size_t> rows{0};
+    StringPool memoPool;
+
+public:
+    size_t size() const { return rows.load(memory_order_relaxed); }
+    bool empty() const { return size() == 0; }
+
+    // Number count new rows and return the first one's offset
+    size_t append(size_t count = 1) { return rows.fetch_add(count, memory_order_relaxed); }
+
+    // Intern a memo for a new record
+    uint32_t intern(string_view memo) { return memoPool.intern(memo); }
+
+    // Render a row's description text
+    string describe(DescriptionKind kind, uint32_t memo) const
+    {
+        const string &text = memoPool.get(memo);
+        switch (kind)
+        {
+        case DESC_INITIAL_DEPOSIT:
+            return "Initial deposit";
+        case DESC_TOP_UP:
+            return "Top-up";
+        case DESC_WITHDRAWAL:
+            return "Withdrawal";
+        case DESC_PURCHASE:
+            return "Purchase: " + text;
+        case DESC_SALE:
+            return "Sale: " + text;
+        case DESC_CUSTOM:
+            break;
+        }
+        return text;
+    }
+};
+
+// Filter-and-sum implementations, slowest first
+enum LedgerKernel
+{
+    KERNEL_SCALAR,
+    KERNEL_SSE42,
+    KERNEL_AVX2
+};
+
+// One account's ledger rows as parallel columns, in ledger order, 22 bytes
+// per row; this is the only copy of a row. The account id is implied by
+// which account's postings hold the row. Scans over an account cost only
+// that account's own activity and run through the SIMD kernels below
+// without a customer filter.
+class AccountPostings
+{
+private:
+    vector<uint32_t> offsets;    // ledger offset, transaction id - 1
+    vector<uint32_t> timestamps; // seconds since RecordEpoch
+    vector<int64_t> amounts;     // Money minor units
+    vector<uint8_t> types;       // TransactionType
+    vector<uint8_t> kinds;       // DescriptionKind
+    vector<uint32_t> memos;      // StringPool id in the ledger
+
+    struct RawTotals
+    {
+        int64_t credit;
+        int64_t debit;
+        int64_t count;
+    };
+
+    // Rows with since <= timestamp < until
+    static RawTotals sumScalar(const uint8_t *type, const int64_t *amount, const uint32_t *timestamp,
+                               size_t count, int64_t since, int64_t until)
+    {
+        RawTotals totals = {0, 0, 0};
+        for (size_t i = 0; i < count; i++)
+        {
+            bool match = timestamp[i] >= since && timestamp[i] < until;
+            int64_t matchMask = -static_cast<int64_t>(match);
+            int64_t creditMask = matchMask & -static_cast<int64_t>(type[i] == CREDIT);
+            totals.credit += amount[i] & creditMask;
+            totals.debit += amount[i] & (matchMask & ~creditMask);
+            totals.count += match;
+        }
+        return totals;
+    }
+
+#ifdef LEDGER_X86_KERNELS
+    __attribute__((target("avx2"))) static RawTotals sumAvx2(const uint8_t *type, const int64_t *amount,
+                                                             const uint32_t *timestamp, size_t count,
+                                                             int64_t since, int64_t until)
+    {
+        const __m256i sinceMinusOne = _mm256_set1_epi64x(since - 1);
+        const __m256i untilVec = _mm256_set1_epi64x(until);
+        const __m256i creditType = _mm256_set1_epi64x(CREDIT);
+        __m256i credit = _mm256_setzero_si256();
+        __m256i debit = _mm256_setzero_si256();
+        __m256i matches = _mm256_setzero_si256();
+
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4)
+        {
+            int32_t packedTypes;
+            __builtin_memcpy(&packedTypes, type + i, sizeof(packedTypes));
+
+            __m256i kind = _mm256_cvtepu8_epi64(_mm_cvtsi32_si128(packedTypes));
+            __m256i ts = _mm256_cvtepu32_epi64(_mm_loadu_si128(reinterpret_cast<const __m128i *>(timestamp + i)));
+            __m256i amt = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(amount + i));
+
+            __m256i match = _mm256_and_si256(_mm256_cmpgt_epi64(ts, sinceMinusOne), _mm256_cmpgt_epi64(untilVec, ts));
+            __m256i isCredit = _mm256_cmpeq_epi64(kind, creditType);
+
+            credit = _mm256_add_epi64(credit, _mm256_and_si256(amt, _mm256_and_si256(match, isCredit)));
+            debit = _mm256_add_epi64(debit, _mm256_and_si256(amt, _mm256_andnot_si256(isCredit, match)));
+            matches = _mm256_sub_epi64(matches, match);
+        }
+
+        alignas(32) int64_t lanes[3][4];
+        _mm256_store_si256(reinterpret_cast<__m256i *>(lanes[0]), credit);
+        _mm256_store_si256(reinterpret_cast<__m256i *>(lanes[1]), debit);
+        _mm256_store_si256(reinterpret_cast<__m256i *>(lanes[2]), matches);
+
+        RawTotals totals = sumScalar(type + i, amount + i, timestamp + i, count - i, since, until);
+        for (int lane = 0; lane < 4; lane++)
+        {
+            totals.credit += lanes[0][lane];
+            totals.debit += lanes[1][lane];
+            totals.count += lanes[2][lane];
+        }
+        return totals;
+    }
+
+    __attribute__((target("sse4.2"))) static RawTotals sumSse42(const uint8_t *type, const int64_t *amount,
+                                                                const uint32_t *timestamp, size_t count,
+                                                                int64_t since, int64_t until)
+    {
+        const __m128i sinceMinusOne = _mm_set1_epi64x(since - 1);
+        const __m128i untilVec = _mm_set1_epi64x(until);
+        const __m128i creditType = _mm_set1_epi64x(CREDIT);
+        __m128i credit = _mm_setzero_si128();
+        __m128i debit = _mm_setzero_si128();
+        __m128i matches = _mm_setzero_si128();
+
+        size_t i = 0;
+        for (; i + 2 <= count; i += 2)
+        {
+            int64_t packedTimestamps;
+            int16_t packedTypes;
+            __builtin_memcpy(&packedTimestamps, timestamp + i, sizeof(packedTimestamps));
+            __builtin_memcpy(&packedTypes, type + i, sizeof(packedTypes));
+
+            __m128i kind = _mm_cvtepu8_epi64(_mm_cvtsi32_si128(packedTypes));
+            __m128i ts = _mm_cvtepu32_epi64(_mm_cvtsi64_si128(packedTimestamps));
+            __m128i amt = _mm_loadu_si128(reinterpret_cast<const __m128i *>(amount + i));
+
+            __m128i match = _mm_and_si128(_mm_cmpgt_epi64(ts, sinceMinusOne), _mm_cmpgt_epi64(untilVec, ts));
+            __m128i isCredit = _mm_cmpeq_epi64(kind, creditType);
+
+            credit = _mm_add_epi64(credit, _mm_and_si128(amt, _mm_and_si128(match, isCredit)));
+            debit = _mm_add_epi64(debit, _mm_and_si128(amt, _mm_andnot_si128(isCredit, match)));
+            matches = _mm_sub_epi64(matches, match);
+        }
+
+        alignas(16) int64_t lanes[3][2];
+        _mm_store_si128(reinterpret_cast<__m128i *>(lanes[0]), credit);
+        _mm_store_si128(reinterpret_cast<__m128i *>(lanes[1]), debit);
+        _mm_store_si128(reinterpret_cast<__m128i *>(lanes[2]), matches);
+
+        RawTotals totals = sumScalar(type + i, amount + i, timestamp + i, count - i, since, until);
+        for (int lane = 0; lane < 2; lane++)
+        {
+            totals.credit += lanes[0][lane];
+            totals.debit += lanes[1][lane];
+            totals.count += lanes[2][lane];
+        }
+        return totals;
+    }
+
+#endif
+
+public:
+    // Fastest kernel this machine supports; sum() uses it by default
+    static LedgerKernel bestKernel()
+    {
+#ifdef LEDGER_X86_KERNELS
+        static const LedgerKernel best = __builtin_cpu_supports("avx2")     ? KERNEL_AVX2
+                                         : __builtin_cpu_supports("sse4.2") ? KERNEL_SSE42
+                                                                            : KERNEL_SCALAR;
+        return best;
+#else
+        return KERNEL_SCALAR;
+#endif
+    }
+
+    static const char *kernelName(LedgerKernel kernel)
+    {
+        static const char *const names[] = {"scalar", "sse4.2", "avx2"};
+        return names[kernel];
+    }
+
+    size_t size() const { return offsets.size(); }
+    bool empty() const { return offsets.empty(); }
+
+    // Add the row at the given ledger offset; offsets stay below 2^32
+    void append(size_t offset, const LedgerRecord &record)
+    {
+        offsets.push_back(static_cast<uint32_t>(offset));
+        timestamps.push_back(record.timestamp);
+        amounts.push_back(record.amount);
+        types.push_back(record.type);
+        kinds.push_back(record.kind);
+        memos.push_back(record.memo);
+    }
+
+    // Index of the first row at or after startTime (rows are in time order)
+    size_t lowerBound(time_t startTime) const
+    {
+        int64_t relative = static_cast<int64_t>(startTime) - RecordEpoch;
+        return static_cast<size_t>(partition_point(timestamps.begin(), timestamps.end(),
+                                                   [&](uint32_t timestamp)
+                                                   {
+                                                       return timestamp < relative;
+                                                   }) -
+                                   timestamps.begin());
+    }
+
+    // Materialize the row at index of accountId's postings as a Transaction
+    Transaction at(size_t index, int accountId, const Ledger &ledger) const
+    {
+        Transaction trans(static_cast<int>(offsets[index]) + 1, accountId, static_cast<TransactionType>(types[index]),
+                          Money::fromMinorUnits(amounts[index]),
+                          ledger.describe(static_cast<DescriptionKind>(kinds[index]), memos[index]));
+        trans.setTimestamp(RecordEpoch + timestamps[index]);
+        return trans;
+    }
+
+    // Credit/debit sums and row count over rows [begin, end) with since <= timestamp < until.
+    // A kernel the machine lacks falls back to the best one it has.
+    LedgerTotals sum(size_t begin, size_t end, time_t since, time_t until, LedgerKernel kernel = bestKernel()) const
+    {
+        kernel = min(kernel, bestKernel());
+        end = min(end, size());
+        if (begin >= end)
+        {
+            return {};
+        }
+
+        const uint8_t *type = types.data() + begin;
+        const int64_t *amount = amounts.data() + begin;
+        const uint32_t *timestamp = timestamps.data() + begin;
+        size_t count = end - begin;
+
+        // Compare in the relative time base; the 64-bit bounds may fall outside 32 bits
+        int64_t relativeSince = static_cast<int64_t>(since) - RecordEpoch;
+        int64_t relativeUntil = static_cast<int64_t>(until) - RecordEpoch;
+
+        RawTotals raw;
+#ifdef LEDGER_X86_KERNELS
+        if (kernel == KERNEL_AVX2)
+        {
+            raw = sumAvx2(type, amount, timestamp, count, relativeSince, relativeUntil);
+        }
+        else if (kernel == KERNEL_SSE42)
+        {
+            raw = sumSse42(type, amount, timestamp, count, relativeSince, relativeUntil);
+        }
+        else
+#endif
+        {
+            raw = sumScalar(type, amount, timestamp, count, relativeSince, relativeUntil);
+        }
+
+        return {Money::fromMinorUnits(raw.credit), Money::fromMinorUnits(raw.debit), static_cast<size_t>(raw.count)};
+    }
+};
+
+#endif // LEDGER_H
@@ -4,13 +4,17 @@
 #include <string>
 #include <ctime>
 #include <iomanip>
+#include <stdexcept>
 #include "bank_customer.h"
 #include "buyer.h"
 #include "seller.h"
 #include "bank.h"
+#include "calendar.h"
 #include "store.h"
 #include "transaction.h"
 #include "serialization.h"
+#include "wal.h"
+#include "thread_pool.h"
 
 using namespace std;
 
@@ -50,6 +54,13 @@ enum SellerMenu
 };
 
 // global data structures
+const string BANK_LOG_PATH = "bank.wal";
+// worker threads for store analytics, besides the thread asking for the report;
+// --analytics-threads=N overrides the default of one per spare hardware thread
+size_t analyticsThreads = thread::hardware_concurrency() > 1 ? thread::hardware_concurrency() - 1 : 0;
+// --approximate-analytics answers the store reports from bounded-memory
+// sketches instead of exact counts
+bool approximateAnalytics = false;
 Bank globalBank("Central Bank");
 Store globalStore("Online Marketplace");
 map<int, Buyer *> buyers;
@@ -66,7 +77,7 @@ struct CartItem
     int itemId;
     string itemName;
     int quantity;
-    double pricePerUnit;
+    Money pricePerUnit;
 };
 vector<CartItem> shoppingCart;
 
@@ -111,7 +122,7 @@ void printOrderStatus(OrderStatus status)
 void registerBuyer()
 {
     string username, password, name;
-    double initialDeposit;
+    Money initialDeposit;
 
     cout << "\n=== Register New Buyer ===" << endl;
     cout << "Enter username: ";
@@ -134,7 +145,7 @@ void registerBuyer()
     cout << "Enter initial deposit: $";
     cin >> initialDeposit;
 
-    if (initialDeposit < 0)
+    if (initialDeposit < Money())
     {
         cout << "Invalid amount!" << endl;
         cout << "\nPress Enter to continue...";
@@ -144,6 +155,13 @@ void registerBuyer()
 
     // create bank account
     BankCustomer *account = globalBank.createAccount(name, initialDeposit);
+    if (!account)
+    {
+        cout << "Bank is full: the limit of " << Bank::MaxAccounts << " accounts has been reached." << endl;
+        cout << "\nPress Enter to continue...";
+        cin.get();
+        return;
+    }
 
     // create buyer account
     Buyer *newBuyer = new Buyer(nextBuyerId, name, *account);
@@ -166,7 +184,7 @@ void registerBuyer()
 void registerSeller()
 {
     string username, password, name;
-    double initialDeposit;
+    Money initialDeposit;
 
     cout << "\n=== Register New Seller ===" << endl;
     cout << "Enter username: ";
@@ -189,7 +207,7 @@ void registerSeller()
     cout << "Enter initial deposit: $";
     cin >> initialDeposit;
 
-    if (initialDeposit < 0)
+    if (initialDeposit < Money())
     {
         cout << "Invalid amount!" << endl;
         cout << "\nPress Enter to continue...";
@@ -199,9 +217,16 @@ void registerSeller()
 
     // create bank account
     BankCustomer *account = globalBank.createAccount(name, initialDeposit);
+    if (!account)
+    {
+        cout << "Bank is full: the limit of " << Bank::MaxAccounts << " accounts has been reached." << endl;
+        cout << "\nPress Enter to continue...";
+        cin.get();
+        return;
+    }
 
     // create seller (upgrading buyer acc)
-    Seller *newSeller = new Seller(nextSellerId, name, *account);
+    Seller *newSeller = new Seller(nextSellerId, name, *account, globalStore.getCatalog());
     sellers[nextSellerId] = newSeller;
     buyers[nextSellerId] = newSeller; 
     userCredentials[username] = {nextSellerId, "seller"};
@@ -219,6 +244,18 @@ void registerSeller()
     nextSellerId++;
 }
 
+// Warn once when the bank log stops being written; later changes are not durable
+void warnIfBankLogFailed()
+{
+    static bool warned = false;
+    if (!warned && globalBank.logFailed())
+    {
+        cout << "\nWARNING: writing the bank log (" << BANK_LOG_PATH << ") failed. "
+             << "Bank changes from now on may be lost on restart." << endl;
+        warned = true;
+    }
+}
+
 // bank functions
 void bankingMenu(Buyer *buyer)
 {
@@ -226,6 +263,7 @@ void bankingMenu(Buyer *buyer)
 
     while (true)
     {
+        warnIfBankLogFailed();
         cout << "\n=== Banking Menu ===" << endl;
         cout << "Current Balance: $" << account.getBalance() << endl;
         cout << "1. Top-up" << endl;
@@ -241,11 +279,11 @@ void bankingMenu(Buyer *buyer)
 
         if (choice == 1)
         {
-            double amount;
+            Money amount;
             cout << "Enter amount to top-up: $";
             cin >> amount;
 
-            if (amount > 0)
+            if (amount > Money())
             {
                 globalBank.topUp(account.getId(), amount);
                 cout << "Top-up successful! New balance: $" << account.getBalance() << endl;
@@ -257,7 +295,7 @@ void bankingMenu(Buyer *buyer)
         }
         else if (choice == 2)
         {
-            double amount;
+            Money amount;
             cout << "Enter amount to withdraw: $";
             cin >> amount;
 
@@ -288,7 +326,7 @@ void bankingMenu(Buyer *buyer)
         else if (choice == 4)
         {
             time_t now = time(nullptr);
-            time_t startOfDay = now - (now % 86400);
+            time_t startOfDay = localDayStart(localDay(now));
             auto cashFlow = globalBank.getCashFlow(account.getId(), startOfDay);
 
             cout << "\n=== Cash Flow (Today) ===" << endl;
@@ -360,36 +398,33 @@ void browseStore(Buyer *buyer)
 
     // find item
     bool found = false;
-    for (auto &sellerPair : sellers)
+    size_t slot;
+    Seller *seller = globalStore.getCatalog().findSeller(itemId, slot);
+    const Item *item = seller ? seller->getItemById(itemId) : nullptr;
+
+    if (item && item->getQuantity() > 0)
     {
-        Seller *seller = sellerPair.second;
-        Item *item = seller->getItemById(itemId);
+        cout << "Enter quantity: ";
+        int qty;
+        cin >> qty;
 
-        if (item && item->getQuantity() > 0)
+        if (qty > 0 && qty <= item->getQuantity())
         {
-            cout << "Enter quantity: ";
-            int qty;
-            cin >> qty;
-
-            if (qty > 0 && qty <= item->getQuantity())
-            {
-                CartItem cartItem;
-                cartItem.sellerId = seller->getId();
-                cartItem.itemId = item->getId();
-                cartItem.itemName = item->getName();
-                cartItem.quantity = qty;
-                cartItem.pricePerUnit = item->getPrice();
-
-                shoppingCart.push_back(cartItem);
-                cout << "Item added to cart!" << endl;
-                found = true;
-                break;
-            }
-            else
-            {
-                cout << "Invalid quantity or insufficient stock!" << endl;
-                return;
-            }
+            CartItem cartItem;
+            cartItem.sellerId = seller->getId();
+            cartItem.itemId = item->getId();
+            cartItem.itemName = item->getName();
+            cartItem.quantity = qty;
+            cartItem.pricePerUnit = item->getPrice();
+
+            shoppingCart.push_back(cartItem);
+            cout << "Item added to cart!" << endl;
+            found = true;
+        }
+        else
+        {
+            cout << "Invalid quantity or insufficient stock!" << endl;
+            return;
         }
     }
 
@@ -399,6 +434,29 @@ void browseStore(Buyer *buyer)
     }
 }
 
+// print the orders a buyer's order query matches
+template <typename Query>
+void printBuyerOrders(const Query &orders)
+{
+    if (orders.empty())
+    {
+        cout << "No orders found." << endl;
+        return;
+    }
+
+    orders.forEach([](const Order &order)
+    {
+        cout << "\nOrder ID: " << order.getOrderId() << endl;
+        cout << "Item: " << globalStore.getItemName(order.getItemId()) << endl;
+        cout << "Quantity: " << order.getQuantity() << endl;
+        cout << "Total: $" << order.getTotalPrice() << endl;
+        cout << "Status: ";
+        printOrderStatus(order.getStatus());
+        cout << endl;
+        cout << "Date: " << getTimeString(order.getTimestamp()) << endl;
+    });
+}
+
 // view and manage orders
 void viewOrders(Buyer *buyer)
 {
@@ -419,35 +477,14 @@ void viewOrders(Buyer *buyer)
 
     if (choice >= 1 && choice <= 5)
     {
-        vector<Order> orders;
-
         if (choice == 1)
         {
-            orders = globalStore.getBuyerOrders(buyer->getId());
+            printBuyerOrders(globalStore.query().buyer(buyer->getId()));
         }
         else
         {
             OrderStatus status = static_cast<OrderStatus>(choice - 2);
-            orders = globalStore.getOrdersByStatus(buyer->getId(), status, true);
-        }
-
-        if (orders.empty())
-        {
-            cout << "No orders found." << endl;
-        }
-        else
-        {
-            for (const auto &order : orders)
-            {
-                cout << "\nOrder ID: " << order.getOrderId() << endl;
-                cout << "Item: " << order.getItemName() << endl;
-                cout << "Quantity: " << order.getQuantity() << endl;
-                cout << "Total: $" << order.getTotalPrice() << endl;
-                cout << "Status: ";
-                printOrderStatus(order.getStatus());
-                cout << endl;
-                cout << "Date: " << getTimeString(order.getTimestamp()) << endl;
-            }
+            printBuyerOrders(globalStore.query().buyer(buyer->getId()).status(status));
         }
     }
     else if (choice == 6)
@@ -460,11 +497,11 @@ void viewOrders(Buyer *buyer)
         }
         else
         {
-            double total = 0;
+            Money total;
             for (size_t i = 0; i < shoppingCart.size(); i++)
             {
                 const auto &item = shoppingCart[i];
-                double itemTotal = item.quantity * item.pricePerUnit;
+                Money itemTotal = item.pricePerUnit * item.quantity;
                 cout << i + 1 << ". " << item.itemName
                      << " x" << item.quantity
                      << " @ $" << item.pricePerUnit
@@ -493,10 +530,10 @@ void viewOrders(Buyer *buyer)
             return;
         }
 
-        double total = 0;
+        Money total;
         for (const auto &item : shoppingCart)
         {
-            total += item.quantity * item.pricePerUnit;
+            total += item.pricePerUnit * item.quantity;
         }
 
         cout << "\n=== Checkout ===" << endl;
@@ -523,9 +560,13 @@ void viewOrders(Buyer *buyer)
                     buyer->getId(),
                     cartItem.sellerId,
                     cartItem.itemId,
-                    cartItem.itemName,
                     cartItem.quantity,
-                    cartItem.quantity * cartItem.pricePerUnit);
+                    cartItem.pricePerUnit * cartItem.quantity);
+                if (orderId == 0)
+                {
+                    cout << "Could not order " << cartItem.itemName << ": invalid quantity " << cartItem.quantity << endl;
+                    continue;
+                }
 
                 // update order status to pending
                 globalStore.updateOrderStatus(orderId, PENDING);
@@ -541,7 +582,7 @@ void viewOrders(Buyer *buyer)
         int k;
         cin >> k;
 
-        double spending = globalStore.getBuyerSpendingLastKDays(buyer->getId(), k);
+        Money spending = globalStore.getBuyerSpendingLastKDays(buyer->getId(), k);
         cout << "Total spending in last " << k << " days: $" << spending << endl;
     }
 }
@@ -551,7 +592,7 @@ void paymentMenu(Buyer *buyer)
 {
     cout << "\n=== Payment ===" << endl;
 
-    auto pendingOrders = globalStore.getOrdersByStatus(buyer->getId(), PENDING, true);
+    auto pendingOrders = globalStore.query().buyer(buyer->getId()).status<PENDING>();
 
     if (pendingOrders.empty())
     {
@@ -560,12 +601,12 @@ void paymentMenu(Buyer *buyer)
     }
 
     cout << "Pending Invoices:" << endl;
-    for (const auto &order : pendingOrders)
+    pendingOrders.forEach([](const Order &order)
     {
         cout << "\nInvoice ID: " << order.getOrderId() << endl;
-        cout << "Item: " << order.getItemName() << endl;
+        cout << "Item: " << globalStore.getItemName(order.getItemId()) << endl;
         cout << "Amount: $" << order.getTotalPrice() << endl;
-    }
+    });
 
     cout << "\nEnter Invoice ID to pay (0 to cancel): ";
     int invoiceId;
@@ -574,7 +615,7 @@ void paymentMenu(Buyer *buyer)
     if (invoiceId == 0)
         return;
 
-    Order *order = globalStore.getOrderById(invoiceId);
+    const Order *order = globalStore.getOrderById(invoiceId);
 
     if (!order || order->getBuyerId() != buyer->getId() || order->getStatus() != PENDING)
     {
@@ -598,22 +639,28 @@ void paymentMenu(Buyer *buyer)
 
     if (confirmId == invoiceId)
     {
-        
-        buyer->getAccount().withdrawBalance(order->getTotalPrice());
-        globalBank.recordTransaction(buyer->getAccount().getId(), DEBIT,
-                                     order->getTotalPrice(), "Purchase: " + order->getItemName());
-
-       
-        Seller *seller = sellers[order->getSellerId()];
-        seller->getAccount().addBalance(order->getTotalPrice());
-        globalBank.recordTransaction(seller->getAccount().getId(), CREDIT,
-                                     order->getTotalPrice(), "Sale: " + order->getItemName());
-
-       
-        Item *item = seller->getItemById(order->getItemId());
-        if (item)
+        auto sellerIt = sellers.find(order->getSellerId());
+        if (sellerIt == sellers.end())
         {
-            item->setQuantity(item->getQuantity() - order->getQuantity());
+            cout << "Seller not found!" << endl;
+            return;
+        }
+        Seller *seller = sellerIt->second;
+
+        // take the stock first so no money moves for an order the seller cannot fill
+        if (!seller->discardItem(order->getItemId(), order->getQuantity()))
+        {
+            cout << "Seller does not have enough stock!" << endl;
+            return;
+        }
+
+        // debit buyer, credit seller and record both legs as one bank operation
+        if (!globalBank.transfer(buyer->getAccount().getId(), seller->getAccount().getId(),
+                                 order->getTotalPrice(), globalStore.getItemName(order->getItemId())))
+        {
+            seller->replenishItem(order->getItemId(), order->getQuantity());
+            cout << "Payment failed!" << endl;
+            return;
         }
 
         globalStore.updateOrderStatus(invoiceId, PAID);
@@ -655,7 +702,7 @@ void addItemMenu(Seller *seller)
 
     string name;
     int quantity;
-    double price;
+    Money price;
 
     cout << "Item name: ";
     cin.ignore();
@@ -665,7 +712,7 @@ void addItemMenu(Seller *seller)
     cout << "Price: $";
     cin >> price;
 
-    if (quantity >= 0 && price >= 0)
+    if (quantity >= 0 && price >= Money())
     {
         seller->addNewItem(nextItemId, name, quantity, price);
         seller->makeItemVisibleToCustomer(nextItemId);
@@ -688,7 +735,7 @@ void updateItemMenu(Seller *seller)
     int itemId;
     cin >> itemId;
 
-    Item *item = seller->getItemById(itemId);
+    const Item *item = seller->getItemById(itemId);
 
     if (!item)
     {
@@ -707,7 +754,7 @@ void updateItemMenu(Seller *seller)
 
     if (choice == 1)
     {
-        double newPrice;
+        Money newPrice;
         cout << "New price: $";
         cin >> newPrice;
 
@@ -746,7 +793,7 @@ void updateItemMenu(Seller *seller)
     {
         string name;
         int qty;
-        double price;
+        Money price;
 
         cout << "New name: ";
         cin.ignore();
@@ -765,29 +812,24 @@ void viewSellerOrders(Seller *seller)
 {
     cout << "\n=== Seller Orders ===" << endl;
 
-    auto orders = globalStore.getSellerOrders(seller->getId());
-
-    if (orders.empty())
+    if (globalStore.query().seller(seller->getId()).empty())
     {
         cout << "No orders found." << endl;
         return;
     }
 
-    for (const auto &order : orders)
+    globalStore.query().seller(seller->getId()).status<PAID, COMPLETED>().forEach([](const Order &order)
     {
-        if (order.getStatus() == PAID || order.getStatus() == COMPLETED)
-        {
-            cout << "\nOrder ID: " << order.getOrderId() << endl;
-            cout << "Buyer ID: " << order.getBuyerId() << endl;
-            cout << "Item: " << order.getItemName() << endl;
-            cout << "Quantity: " << order.getQuantity() << endl;
-            cout << "Total: $" << order.getTotalPrice() << endl;
-            cout << "Status: ";
-            printOrderStatus(order.getStatus());
-            cout << endl;
-            cout << "Date: " << getTimeString(order.getTimestamp()) << endl;
-        }
-    }
+        cout << "\nOrder ID: " << order.getOrderId() << endl;
+        cout << "Buyer ID: " << order.getBuyerId() << endl;
+        cout << "Item: " << globalStore.getItemName(order.getItemId()) << endl;
+        cout << "Quantity: " << order.getQuantity() << endl;
+        cout << "Total: $" << order.getTotalPrice() << endl;
+        cout << "Status: ";
+        printOrderStatus(order.getStatus());
+        cout << endl;
+        cout << "Date: " << getTimeString(order.getTimestamp()) << endl;
+    });
 
     cout << "\nMark order as completed? (Enter Order ID or 0): ";
     int orderId;
@@ -795,7 +837,7 @@ void viewSellerOrders(Seller *seller)
 
     if (orderId > 0)
     {
-        Order *order = globalStore.getOrderById(orderId);
+        const Order *order = globalStore.getOrderById(orderId);
         if (order && order->getSellerId() == seller->getId() && order->getStatus() == PAID)
         {
             globalStore.updateOrderStatus(orderId, COMPLETED);
@@ -825,7 +867,15 @@ void sellerAnalytics(Seller *seller)
         int k;
         cin >> k;
 
-        auto topItems = globalStore.getTopMSoldItems(k);
+        time_t now = time(nullptr);
+        struct tm *timeInfo = localtime(&now);
+        timeInfo->tm_mday = 1;
+        timeInfo->tm_hour = 0;
+        timeInfo->tm_min = 0;
+        timeInfo->tm_sec = 0;
+        time_t startOfMonth = mktime(timeInfo);
+
+        auto topItems = globalStore.getTopMSoldItems(k, startOfMonth, seller->getId());
 
         cout << "\n=== Top " << k << " Most Sold Items ===" << endl;
         for (size_t i = 0; i < topItems.size(); i++)
@@ -839,6 +889,7 @@ void sellerAnalytics(Seller *seller)
         auto loyalCustomers = globalStore.getLoyalCustomers(seller->getId());
 
         cout << "\n=== Loyal Customers ===" << endl;
+        cout << "Distinct buyers this month: " << globalStore.getDistinctBuyersThisMonth(seller->getId()) << endl;
         if (loyalCustomers.empty())
         {
             cout << "No loyal customers yet." << endl;
@@ -912,7 +963,7 @@ void buyerMenu(int userId)
 
                 if (confirm == 1)
                 {
-                    Seller *newSeller = new Seller(userId, buyer->getName(), buyer->getAccount());
+                    Seller *newSeller = new Seller(userId, buyer->getName(), buyer->getAccount(), globalStore.getCatalog());
                     sellers[userId] = newSeller;
                     cout << "Account upgraded to Seller!" << endl;
                 }
@@ -1037,17 +1088,16 @@ void adminMenu()
         else if (choice == 3)
         {
             cout << "\n=== All Bank Accounts ===" << endl;
-            auto accounts = globalBank.getAllCustomers();
-            for (const auto &acc : accounts)
+            for (const auto &acc : globalBank.getAllCustomers())
             {
-                acc->printInfo();
+                acc.printInfo();
                 cout << "---" << endl;
             }
         }
         else if (choice == 4)
         {
             cout << "\n=== Dormant Accounts (30+ days) ===" << endl;
-            auto dormant = globalBank.getDormantAccounts();
+            auto dormant = globalBank.getDormantAccounts(30);
 
             if (dormant.empty())
             {
@@ -1111,7 +1161,7 @@ void adminMenu()
             }
             else if (subChoice == 2)
             {
-                auto orders = globalStore.getPaidNotCompletedOrders();
+                auto orders = globalStore.query().status<PAID>();
                 cout << "\n=== Paid but Not Completed ===" << endl;
 
                 if (orders.empty())
@@ -1120,12 +1170,12 @@ void adminMenu()
                 }
                 else
                 {
-                    for (const auto &order : orders)
+                    orders.forEach([](const Order &order)
                     {
                         cout << "Order ID: " << order.getOrderId()
-                             << " | Item: " << order.getItemName()
+                             << " | Item: " << globalStore.getItemName(order.getItemId())
                              << " | Amount: $" << order.getTotalPrice() << endl;
-                    }
+                    });
                 }
             }
             else if (subChoice == 3)
@@ -1145,10 +1195,10 @@ void adminMenu()
             }
             else if (subChoice == 4)
             {
-                auto activeBuyers = globalStore.getMostActiveBuyersToday();
+                auto activeBuyers = globalStore.getMostActiveBuyersToday(10);
                 cout << "\n=== Most Active Buyers Today ===" << endl;
 
-                for (size_t i = 0; i < activeBuyers.size() && i < 10; i++)
+                for (size_t i = 0; i < activeBuyers.size(); i++)
                 {
                     Buyer *buyer = buyers[activeBuyers[i].first];
                     cout << i + 1 << ". " << buyer->getName()
@@ -1157,10 +1207,10 @@ void adminMenu()
             }
             else if (subChoice == 5)
             {
-                auto activeSellers = globalStore.getMostActiveSellersToday();
+                auto activeSellers = globalStore.getMostActiveSellersToday(10);
                 cout << "\n=== Most Active Sellers Today ===" << endl;
 
-                for (size_t i = 0; i < activeSellers.size() && i < 10; i++)
+                for (size_t i = 0; i < activeSellers.size(); i++)
                 {
                     Seller *seller = sellers[activeSellers[i].first];
                     cout << i + 1 << ". " << seller->getName()
@@ -1177,18 +1227,75 @@ void adminMenu()
 }
 
 // main function
-int main()
+int main(int argc, char *argv[])
 {
     const string ADMIN_USERNAME = "root";
     const string ADMIN_PASSWORD = "toor";
 
+    for (int i = 1; i < argc; i++)
+    {
+        string arg = argv[i];
+        const string threadsFlag = "--analytics-threads=";
+        size_t digits = arg.size() - min(arg.size(), threadsFlag.size());
+        if (arg.rfind(threadsFlag, 0) == 0 && digits >= 1 && digits <= 4 &&
+            arg.find_first_not_of("0123456789", threadsFlag.size()) == string::npos)
+        {
+            analyticsThreads = stoul(arg.substr(threadsFlag.size()));
+        }
+        else if (arg == "--approximate-analytics")
+        {
+            approximateAnalytics = true;
+        }
+        else
+        {
+            cout << "Usage: " << argv[0] << " [--analytics-threads=N] [--approximate-analytics]" << endl;
+            return 1;
+        }
+    }
+
     cout << "=== Online Store System ===" << endl;
     cout << "Loading data..." << endl;
 
-   
+    // rebuild bank state from the write-ahead log, then log every new mutation
+    size_t rejected = 0;
+    size_t replayed;
+    try
+    {
+        replayed = globalBank.replayLog(BANK_LOG_PATH, &rejected);
+    }
+    catch (const runtime_error &error)
+    {
+        // leave an unreadable log untouched rather than start over it
+        cout << "ERROR: " << error.what() << endl;
+        return 1;
+    }
+    WriteAheadLog bankLog(BANK_LOG_PATH);
+    if (bankLog.isOpen())
+    {
+        globalBank.attachLog(&bankLog);
+    }
+    else
+    {
+        cout << "WARNING: cannot open the bank log (" << BANK_LOG_PATH << "). "
+             << "Bank changes will not be saved." << endl;
+    }
+    cout << "Restored " << replayed << " bank log records." << endl;
+    if (rejected > 0)
+    {
+        cout << "WARNING: " << rejected << " bank log records did not match the restored balances and were skipped." << endl;
+    }
+
+    ThreadPool analyticsPool(analyticsThreads);
+    globalStore.setAnalyticsPool(&analyticsPool);
+    if (approximateAnalytics)
+    {
+        globalStore.enableApproximateAnalytics(SketchOptions());
+    }
 
     while (true)
     {
+        warnIfBankLogFailed();
+
         cout << "\n========================================" << endl;
         cout << "        MAIN MENU" << endl;
         cout << "========================================" << endl;
@@ -1273,7 +1380,10 @@ int main()
         {
            
             cout << "\nSaving data..." << endl;
-
+            if (bankLog.isOpen() && !bankLog.sync())
+            {
+                cout << "Saving the bank log failed!" << endl;
+            }
 
             cout << "Thank you for using the system!" << endl;
             break;
@@ -1304,10 +1414,17 @@ int main()
     }
 
 
+    globalBank.attachLog(nullptr);
+    globalStore.setAnalyticsPool(nullptr);
+
     for (auto &pair : buyers)
     {
         delete pair.second;
     }
+    for (auto &pair : sellers)
+    {
+        delete pair.second;
+    }
 
     return 0;
 }
\ No newline at end of file
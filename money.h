@@ -0,0 +1,148 @@
+#ifndef MONEY_H
+#define MONEY_H
+
+#include <cctype>
+#include <compare>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+
+// Fixed-point amount in minor units (cents).
+// Arithmetic is exact and throws overflow_error instead of wrapping.
+class Money
+{
+private:
+    int64_t cents;
+
+    explicit constexpr Money(int64_t minorUnits) : cents(minorUnits) {}
+
+public:
+    constexpr Money() : cents(0) {}
+
+    static constexpr Money fromMinorUnits(int64_t minorUnits) { return Money(minorUnits); }
+
+    // Parse a decimal string such as "12", "-3.5" or "0.125" (rounded to cents)
+    static Money parse(const string &text)
+    {
+        size_t i = 0;
+        bool negative = false;
+        if (i < text.size() && (text[i] == '-' || text[i] == '+'))
+        {
+            negative = text[i] == '-';
+            i++;
+        }
+
+        Money units;
+        bool anyDigit = false;
+        for (; i < text.size() && isdigit(static_cast<unsigned char>(text[i])); i++)
+        {
+            units = units * 10 + Money(100 * (text[i] - '0'));
+            anyDigit = true;
+        }
+
+        if (i < text.size() && text[i] == '.')
+        {
+            i++;
+            int64_t scale = 10;
+            for (; i < text.size() && isdigit(static_cast<unsigned char>(text[i])); i++)
+            {
+                int digit = text[i] - '0';
+                if (scale > 0)
+                {
+                    units = units + Money(digit * scale);
+                    scale /= 10;
+                }
+                else if (scale == 0)
+                {
+                    // first digit past the cents decides rounding
+                    if (digit >= 5)
+                    {
+                        units = units + Money(1);
+                    }
+                    scale = -1;
+                }
+                anyDigit = true;
+            }
+        }
+
+        if (!anyDigit || i != text.size())
+        {
+            throw invalid_argument("Invalid money amount: " + text);
+        }
+        return negative ? -units : units;
+    }
+
+    int64_t minorUnits() const { return cents; }
+
+    Money operator+(Money other) const
+    {
+        int64_t result;
+        if (__builtin_add_overflow(cents, other.cents, &result))
+        {
+            throw overflow_error("Money overflow");
+        }
+        return Money(result);
+    }
+
+    Money operator-(Money other) const
+    {
+        int64_t result;
+        if (__builtin_sub_overflow(cents, other.cents, &result))
+        {
+            throw overflow_error("Money overflow");
+        }
+        return Money(result);
+    }
+
+    Money operator*(int64_t factor) const
+    {
+        int64_t result;
+        if (__builtin_mul_overflow(cents, factor, &result))
+        {
+            throw overflow_error("Money overflow");
+        }
+        return Money(result);
+    }
+
+    Money operator-() const { return Money() - *this; }
+
+    Money &operator+=(Money other) { return *this = *this + other; }
+    Money &operator-=(Money other) { return *this = *this - other; }
+
+    auto operator<=>(const Money &) const = default;
+};
+
+inline ostream &operator<<(ostream &out, Money amount)
+{
+    int64_t cents = amount.minorUnits();
+    uint64_t magnitude = cents < 0 ? 0 - static_cast<uint64_t>(cents) : static_cast<uint64_t>(cents);
+    if (cents < 0)
+    {
+        out << '-';
+    }
+    out << magnitude / 100 << '.' << setw(2) << setfill('0') << magnitude % 100 << setfill(' ');
+    return out;
+}
+
+inline istream &operator>>(istream &in, Money &amount)
+{
+    string token;
+    if (in >> token)
+    {
+        try
+        {
+            amount = Money::parse(token);
+        }
+        catch (const exception &)
+        {
+            in.setstate(ios::failbit);
+        }
+    }
+    return in;
+}
+
+#endif // MONEY_H
@@ -3,6 +3,8 @@
 
 #include "buyer.h"
 #include "item.h"
+#include "item_catalog.h"
+#include <span>
 #include <string>
 #include <vector>
 
@@ -12,69 +14,77 @@ class Seller : public Buyer
 {
 private:
     vector<Item> items;
+    ItemCatalog &catalog; // the store's, kept in sync with items
+
+    // Whether this seller lists itemId; slot is set to its index in items
+    bool findSlot(int itemId, size_t &slot) const { return catalog.findSeller(itemId, slot) == this; }
+
+    Item *findItem(int itemId)
+    {
+        size_t slot;
+        return findSlot(itemId, slot) ? &items[slot] : nullptr;
+    }
 
 public:
-    Seller(int id, const string &name, BankCustomer &account)
-        : Buyer(id, name, account) {}
+    // catalog must outlive the seller
+    Seller(int id, const string &name, BankCustomer &account, ItemCatalog &catalog)
+        : Buyer(id, name, account), catalog(catalog) {}
 
-    virtual ~Seller() = default;
+    virtual ~Seller()
+    {
+        for (const auto &item : items)
+        {
+            catalog.release(item.getId(), this);
+        }
+    }
 
     // Add new item
-    void addNewItem(int newId, const string &newName, int newQuantity, double newPrice)
+    void addNewItem(int newId, const string &newName, int newQuantity, Money newPrice)
     {
         Item newItem(newId, newName, newQuantity, newPrice);
         items.push_back(newItem);
+        catalog.setName(newId, newName);
+        catalog.place(newId, this, items.size() - 1);
     }
 
     // Update item
-    void updateItem(int itemId, const string &newName, int newQuantity, double newPrice)
+    void updateItem(int itemId, const string &newName, int newQuantity, Money newPrice)
     {
-        for (auto &item : items)
+        Item *item = findItem(itemId);
+        if (item)
         {
-            if (item.getId() == itemId)
-            {
-                item.alterItemById(itemId, newName, newQuantity, newPrice);
-                break;
-            }
+            item->alterItemById(itemId, newName, newQuantity, newPrice);
+            catalog.setName(itemId, newName);
         }
     }
 
     // Make item visible to customers
     void makeItemVisibleToCustomer(int itemId)
     {
-        for (auto &item : items)
+        Item *item = findItem(itemId);
+        if (item)
         {
-            if (item.getId() == itemId)
-            {
-                item.setDisplay(true);
-                break;
-            }
+            item->setDisplay(true);
         }
     }
 
-    // Get all items
-    vector<Item> &getItems()
+    // Get all items; change them through the methods above and below
+    span<const Item> getItems() const
     {
         return items;
     }
 
-    // Get item by ID
-    Item *getItemById(int itemId)
+    // Get item by ID through the marketplace catalog
+    const Item *getItemById(int itemId) const
     {
-        for (auto &item : items)
-        {
-            if (item.getId() == itemId)
-            {
-                return &item;
-            }
-        }
-        return nullptr;
+        size_t slot;
+        return findSlot(itemId, slot) ? &items[slot] : nullptr;
     }
 
     // Replenish item stock
     bool replenishItem(int itemId, int quantity)
     {
-        Item *item = getItemById(itemId);
+        Item *item = findItem(itemId);
         if (item)
         {
             item->setQuantity(item->getQuantity() + quantity);
@@ -86,7 +96,7 @@ public:
     // Discard item stock
     bool discardItem(int itemId, int quantity)
     {
-        Item *item = getItemById(itemId);
+        Item *item = findItem(itemId);
         if (item && item->getQuantity() >= quantity)
         {
             item->setQuantity(item->getQuantity() - quantity);
@@ -96,9 +106,9 @@ public:
     }
 
     // Update price
-    bool updatePrice(int itemId, double newPrice)
+    bool updatePrice(int itemId, Money newPrice)
     {
-        Item *item = getItemById(itemId);
+        Item *item = findItem(itemId);
         if (item)
         {
             item->setPrice(newPrice);
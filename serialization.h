@@ -23,12 +23,11 @@ public:
         file << bank.getName() << endl;
         file << bank.getCustomerCount() << endl;
 
-        auto customers = bank.getAllCustomers();
-        for (const auto &customer : customers)
+        for (const auto &customer : bank.getAllCustomers())
         {
-            file << customer->getId() << ","
-                 << customer->getName() << ","
-                 << customer->getBalance() << endl;
+            file << customer.getId() << ","
+                 << customer.getName() << ","
+                 << customer.getBalance() << endl;
         }
 
         file.close();
@@ -61,7 +60,7 @@ public:
             getline(ss, balance, ',');
 
            
-            double bal = stod(balance);
+            Money bal = Money::parse(balance);
             bank.createAccount(customerName, bal);
         }
 
@@ -76,14 +75,13 @@ public:
 
         file << store.getStoreName() << endl;
 
-        auto orders = store.getAllOrders();
-        for (const auto &order : orders)
+        for (const auto &order : store.getAllOrders())
         {
             file << order.getOrderId() << ","
                  << order.getBuyerId() << ","
                  << order.getSellerId() << ","
                  << order.getItemId() << ","
-                 << order.getItemName() << ","
+                 << store.getItemName(order.getItemId()) << ","
                  << order.getQuantity() << ","
                  << order.getTotalPrice() << ","
                  << order.getStatus() << ","
@@ -127,9 +125,10 @@ public:
             int sid = stoi(sellerId);
             int iid = stoi(itemId);
             int qty = stoi(quantity);
-            double prc = stod(price);
+            Money prc = Money::parse(price);
 
-            store.createOrder(bid, sid, iid, itemName, qty, prc);
+            // item names belong to the sellers' catalog, not to saved orders
+            store.createOrder(bid, sid, iid, qty, prc);
             
         }
 
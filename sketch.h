@@ -0,0 +1,199 @@
+#ifndef SKETCH_H
+#define SKETCH_H
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <set>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+// Error bounds for the approximate analytics sketches
+struct SketchOptions
+{
+    double epsilon = 0.001;   // Count-Min over-count is at most epsilon * total count...
+    double delta = 0.01;      // ...except with probability delta
+    size_t heavyHitters = 64; // candidates tracked per top-K report
+    int hllPrecision = 12;    // HyperLogLog uses 2^p registers, error about 1.04 / sqrt(2^p)
+};
+
+inline uint64_t mixHash(uint64_t key)
+{
+    key += 0x9e3779b97f4a7c15ull;
+    key = (key ^ (key >> 30)) * 0xbf58476d1ce4e5b9ull;
+    key = (key ^ (key >> 27)) * 0x94d049bb133111ebull;
+    return key ^ (key >> 31);
+}
+
+// Count-Min sketch: with only non-negative increments, estimates never
+// under-count and over-count by at most epsilon * total with probability
+// 1 - delta. Decrements would void both bounds, so callers never subtract.
+class CountMinSketch
+{
+private:
+    size_t width;
+    size_t depth;
+    vector<int64_t> cells; // depth rows of width counters
+
+    size_t cell(size_t row, uint64_t key) const
+    {
+        return row * width + mixHash(key + row * 0x632be59bd9b4e019ull) % width;
+    }
+
+public:
+    CountMinSketch(double epsilon, double delta)
+        : width(max<size_t>(1, static_cast<size_t>(ceil(exp(1.0) / epsilon)))),
+          depth(max<size_t>(1, static_cast<size_t>(ceil(log(1.0 / delta))))),
+          cells(width * depth, 0) {}
+
+    // count must be non-negative
+    void add(uint64_t key, int64_t count)
+    {
+        for (size_t row = 0; row < depth; row++)
+        {
+            cells[cell(row, key)] += count;
+        }
+    }
+
+    int64_t estimate(uint64_t key) const
+    {
+        int64_t best = cells[cell(0, key)];
+        for (size_t row = 1; row < depth; row++)
+        {
+            best = min(best, cells[cell(row, key)]);
+        }
+        return best;
+    }
+};
+
+// The ids with the largest estimates offered so far, in bounded memory: a
+// fixed number of candidates ordered by estimate, where a new id replaces the
+// smallest candidate once its estimate is larger. Estimates of an id must
+// never go down, which holds for Count-Min estimates of increment-only counts.
+class TopCandidates
+{
+private:
+    // smallest estimate first; equal estimates keep the lowest id last
+    struct ByEstimate
+    {
+        bool operator()(const pair<int64_t, int> &a, const pair<int64_t, int> &b) const
+        {
+            return a.first != b.first ? a.first < b.first : a.second > b.second;
+        }
+    };
+
+    size_t capacity;
+    unordered_map<int, int64_t> candidates; // id -> estimate in ranking
+    set<pair<int64_t, int>, ByEstimate> ranking;
+
+public:
+    explicit TopCandidates(size_t capacity) : capacity(max<size_t>(capacity, 1)) {}
+
+    // Record id's current estimate
+    void offer(int id, int64_t estimate)
+    {
+        auto found = candidates.find(id);
+        if (found != candidates.end())
+        {
+            ranking.erase({found->second, id});
+            found->second = estimate;
+            ranking.insert({estimate, id});
+            return;
+        }
+        if (candidates.size() == capacity)
+        {
+            auto smallest = ranking.begin();
+            if (estimate <= smallest->first)
+            {
+                return;
+            }
+            candidates.erase(smallest->second);
+            ranking.erase(smallest);
+        }
+        candidates[id] = estimate;
+        ranking.insert({estimate, id});
+    }
+
+    // Up to k (id, estimate) pairs with positive estimates, largest first
+    vector<pair<int, int64_t>> top(size_t k) const
+    {
+        vector<pair<int, int64_t>> result;
+        for (auto it = ranking.rbegin(); it != ranking.rend() && result.size() < k && it->first > 0; ++it)
+        {
+            result.push_back({it->second, it->first});
+        }
+        return result;
+    }
+};
+
+// Top-K by Count-Min estimate in bounded memory
+class HeavyHitters
+{
+private:
+    CountMinSketch counts;
+    TopCandidates candidates;
+
+public:
+    explicit HeavyHitters(const SketchOptions &options)
+        : counts(options.epsilon, options.delta), candidates(options.heavyHitters) {}
+
+    // count must be non-negative
+    void add(int id, int64_t count)
+    {
+        counts.add(static_cast<uint64_t>(id), count);
+        candidates.offer(id, counts.estimate(static_cast<uint64_t>(id)));
+    }
+
+    int64_t estimate(int id) const { return counts.estimate(static_cast<uint64_t>(id)); }
+
+    // Up to k (id, estimated count) pairs with positive counts, largest first
+    vector<pair<int, int64_t>> top(size_t k) const { return candidates.top(k); }
+};
+
+// HyperLogLog distinct counter in 2^precision one-byte registers
+class HyperLogLog
+{
+private:
+    int precision;
+    vector<uint8_t> registers;
+
+public:
+    explicit HyperLogLog(int precision = 12)
+        : precision(clamp(precision, 4, 18)), registers(static_cast<size_t>(1) << this->precision, 0) {}
+
+    void add(uint64_t key)
+    {
+        uint64_t hash = mixHash(key);
+        size_t index = static_cast<size_t>(hash >> (64 - precision));
+        uint64_t rest = hash << precision;
+        uint8_t rank = static_cast<uint8_t>(min(countl_zero(rest), 64 - precision) + 1);
+        registers[index] = max(registers[index], rank);
+    }
+
+    double estimate() const
+    {
+        double m = static_cast<double>(registers.size());
+        double sum = 0;
+        size_t zeros = 0;
+        for (uint8_t value : registers)
+        {
+            sum += ldexp(1.0, -value);
+            zeros += value == 0;
+        }
+
+        double alpha = 0.7213 / (1.0 + 1.079 / m);
+        double raw = alpha * m * m / sum;
+        if (raw <= 2.5 * m && zeros > 0)
+        {
+            // linear counting is more accurate while many registers are empty
+            return m * log(m / static_cast<double>(zeros));
+        }
+        return raw;
+    }
+};
+
+#endif // SKETCH_H
@@ -0,0 +1,125 @@
+#ifndef SLAB_H
+#define SLAB_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <iterator>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+using namespace std;
+
+// Chunked arena with stable addresses.
+// Objects are built in place inside fixed-size chunks, so growing the slab
+// never moves existing records and neighbours share cache lines.
+// One writer at a time may emplace_back while other threads read: a record
+// becomes visible to readers only once it is fully constructed.
+// The chunk table is a fixed array so readers never see it reallocate, which
+// caps a slab at ChunkSize * MaxChunks records (about 4.2M with the defaults);
+// emplace_back throws length_error past that.
+template <typename T, size_t ChunkSize = 1024, size_t MaxChunks = 4096>
+class Slab
+{
+    static_assert((ChunkSize & (ChunkSize - 1)) == 0, "ChunkSize must be a power of two");
+
+private:
+    array<T *, MaxChunks> chunks{};
+    atomic<size_t> count;
+
+public:
+    template <bool Const>
+    class Iterator
+    {
+    private:
+        using SlabType = conditional_t<Const, const Slab, Slab>;
+        SlabType *slab;
+        size_t index;
+
+    public:
+        using iterator_category = forward_iterator_tag;
+        using value_type = T;
+        using difference_type = ptrdiff_t;
+        using pointer = conditional_t<Const, const T *, T *>;
+        using reference = conditional_t<Const, const T &, T &>;
+
+        Iterator() : slab(nullptr), index(0) {}
+        Iterator(SlabType *slab, size_t index) : slab(slab), index(index) {}
+
+        reference operator*() const { return (*slab)[index]; }
+        pointer operator->() const { return &(*slab)[index]; }
+
+        Iterator &operator++()
+        {
+            index++;
+            return *this;
+        }
+
+        Iterator operator++(int)
+        {
+            Iterator copy = *this;
+            index++;
+            return copy;
+        }
+
+        bool operator==(const Iterator &other) const { return index == other.index; }
+        bool operator!=(const Iterator &other) const { return index != other.index; }
+    };
+
+    using iterator = Iterator<false>;
+    using const_iterator = Iterator<true>;
+
+    Slab() : count(0) {}
+
+    Slab(const Slab &) = delete;
+    Slab &operator=(const Slab &) = delete;
+
+    ~Slab()
+    {
+        for (size_t i = 0; i < size(); i++)
+        {
+            (*this)[i].~T();
+        }
+        for (auto chunk : chunks)
+        {
+            ::operator delete(chunk);
+        }
+    }
+
+    // Construct a new record at the end of the slab
+    template <typename... Args>
+    T &emplace_back(Args &&...args)
+    {
+        size_t index = count.load(memory_order_relaxed);
+        size_t chunk = index / ChunkSize;
+        if (chunk >= MaxChunks)
+        {
+            throw length_error("Slab capacity exceeded");
+        }
+        if (!chunks[chunk])
+        {
+            chunks[chunk] = static_cast<T *>(::operator new(sizeof(T) * ChunkSize));
+        }
+
+        T *slot = chunks[chunk] + (index % ChunkSize);
+        new (slot) T(std::forward<Args>(args)...);
+        count.store(index + 1, memory_order_release);
+        return *slot;
+    }
+
+    T &operator[](size_t index) { return chunks[index / ChunkSize][index % ChunkSize]; }
+    const T &operator[](size_t index) const { return chunks[index / ChunkSize][index % ChunkSize]; }
+
+    static constexpr size_t capacity() { return ChunkSize * MaxChunks; }
+    size_t size() const { return count.load(memory_order_acquire); }
+    bool empty() const { return size() == 0; }
+
+    iterator begin() { return iterator(this, 0); }
+    iterator end() { return iterator(this, size()); }
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, size()); }
+};
+
+#endif // SLAB_H
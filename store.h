@@ -5,276 +5,1070 @@
 #include "item.h"
 #include "buyer.h"
 #include "seller.h"
+#include "item_catalog.h"
+#include "daily_fenwick.h"
+#include "activity_counter.h"
+#include "calendar.h"
+#include "thread_pool.h"
+#include "sketch.h"
 #include <vector>
 #include <string>
-#include <map>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <set>
+#include <span>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
 #include <ctime>
 #include <algorithm>
 
 using namespace std;
 
+template <typename... Filters>
+class OrderQuery;
+
 class Store
 {
+    template <typename... Filters>
+    friend class OrderQuery;
+
 private:
     string storeName;
+    ItemCatalog catalog; // item names and listings of this store's sellers
     vector<Order> orders;
+    // order id N -> index of the order in orders. Lookups always go through
+    // this table instead of assuming index == id - 1, so orders can later be
+    // compacted or archived by moving them and patching their entry.
+    vector<size_t> orderSlots;
+    // buyer / seller id -> ids of their orders, oldest first
+    unordered_map<int, vector<int>> ordersByBuyer;
+    unordered_map<int, vector<int>> ordersBySeller;
     int nextOrderId;
 
-public:
-    Store(const string &name) : storeName(name), nextOrderId(1) {}
+    // Orders of each status form an intrusive doubly-linked list threaded
+    // through statusLinks (order id N at N - 1; 0 ends a list). Orders move
+    // between lists in updateOrderStatus, so listing one status is O(its size).
+    struct StatusLink
+    {
+        int prev = 0;
+        int next = 0;
+    };
+    struct StatusList
+    {
+        int head = 0;
+        int tail = 0;
+    };
+    static constexpr size_t OrderStatusCount = 4;
+    vector<StatusLink> statusLinks;
+    array<StatusList, OrderStatusCount> statusLists;
 
-    string getStoreName() const { return storeName; }
+    void linkStatus(int orderId, OrderStatus status)
+    {
+        StatusList &list = statusLists[status];
+        StatusLink &link = statusLinks[orderId - 1];
+        link.prev = list.tail;
+        link.next = 0;
+        if (list.tail)
+        {
+            statusLinks[list.tail - 1].next = orderId;
+        }
+        else
+        {
+            list.head = orderId;
+        }
+        list.tail = orderId;
+    }
 
-    // Create new order
-    int createOrder(int buyerId, int sellerId, int itemId, const string &itemName,
-                    int quantity, double totalPrice)
+    void unlinkStatus(int orderId, OrderStatus status)
     {
-        Order newOrder(nextOrderId, buyerId, sellerId, itemId, itemName, quantity, totalPrice);
-        orders.push_back(newOrder);
-        return nextOrderId++;
+        StatusList &list = statusLists[status];
+        StatusLink &link = statusLinks[orderId - 1];
+        (link.prev ? statusLinks[link.prev - 1].next : list.head) = link.next;
+        (link.next ? statusLinks[link.next - 1].prev : list.tail) = link.prev;
+        link = StatusLink();
     }
 
-    // Update order status
-    bool updateOrderStatus(int orderId, OrderStatus status)
+    // Units sold per item over PAID and COMPLETED orders, bucketed by order day
+    struct ItemSales
     {
-        for (auto &order : orders)
+        int itemId;
+        int sellerId;
+        DailyFenwick<int> units;
+    };
+    vector<ItemSales> itemSales;
+    unordered_map<int, size_t> itemSalesSlots;            // item id -> index in itemSales
+    unordered_map<int, vector<size_t>> itemSalesBySeller; // seller id -> indexes in itemSales
+
+    // PAID and COMPLETED spend per buyer, bucketed by order day
+    unordered_map<int, DailyFenwick<Money>> buyerSpending;
+
+    // Per-seller purchase counts by buyer for one (local) calendar month, plus
+    // the buyers above the loyalty threshold. A sale from a later month
+    // starts the table over; sales from earlier months no longer count.
+    struct MonthlyBuyers
+    {
+        int month = -1; // years * 12 + month, see monthOf
+        unordered_map<int, int> purchases;
+        set<int> loyal;
+    };
+    static constexpr int LoyaltyThreshold = 1; // loyal means more purchases than this
+    unordered_map<int, MonthlyBuyers> sellerBuyers;
+
+    static int monthOf(time_t timestamp)
+    {
+        struct tm *timeInfo = localtime(&timestamp);
+        return timeInfo->tm_year * 12 + timeInfo->tm_mon;
+    }
+
+    void recordMonthlyPurchase(const Order &order, int sign)
+    {
+        MonthlyBuyers &buyersOfSeller = sellerBuyers[order.getSellerId()];
+        int month = monthOf(order.getTimestamp());
+        if (month < buyersOfSeller.month)
+        {
+            return;
+        }
+        if (month > buyersOfSeller.month)
+        {
+            buyersOfSeller = MonthlyBuyers();
+            buyersOfSeller.month = month;
+        }
+
+        int buyerId = order.getBuyerId();
+        int &count = buyersOfSeller.purchases[buyerId];
+        count += sign;
+        if (count > LoyaltyThreshold)
         {
-            if (order.getOrderId() == orderId)
+            buyersOfSeller.loyal.insert(buyerId);
+        }
+        else
+        {
+            buyersOfSeller.loyal.erase(buyerId);
+            if (count <= 0)
             {
-                order.setStatus(status);
-                return true;
+                buyersOfSeller.purchases.erase(buyerId);
             }
         }
-        return false;
     }
 
-    // Get all orders for a buyer
-    vector<Order> getBuyerOrders(int buyerId) const
+    // Bounded-memory sketches that replace the item, activity and monthly
+    // buyer tables in approximate mode (buyer spend stays exact). Count-Min
+    // counts only grow, so a paid order cancelled later is not taken back and
+    // unit estimates bound net sales from above.
+    struct SellerSketches
     {
-        vector<Order> buyerOrders;
-        for (const auto &order : orders)
+        TopCandidates items;        // all-time units per item
+        int month = -1;             // month of the fields below, see monthOf
+        TopCandidates monthItems;   // units per item this month
+        TopCandidates repeatBuyers; // purchases per buyer this month
+        HyperLogLog buyers;         // distinct buyers this month
+
+        explicit SellerSketches(const SketchOptions &options)
+            : items(options.heavyHitters), monthItems(options.heavyHitters),
+              repeatBuyers(options.heavyHitters), buyers(options.hllPrecision) {}
+    };
+    struct ApproximateAnalytics
+    {
+        SketchOptions options;
+        HeavyHitters itemUnits;        // all-time units sold per item
+        int month = -1;                // month of the two sketches below
+        HeavyHitters monthItemUnits;   // units sold per item this month
+        CountMinSketch monthPurchases; // purchases per (seller, buyer) this month
+        unordered_map<int, SellerSketches> sellers;
+        time_t day = -1;          // day of the two sketches below
+        HeavyHitters buyerOrders; // orders per buyer today
+        HeavyHitters sellerOrders;
+
+        explicit ApproximateAnalytics(const SketchOptions &options)
+            : options(options), itemUnits(options), monthItemUnits(options),
+              monthPurchases(options.epsilon, options.delta), buyerOrders(options), sellerOrders(options) {}
+    };
+    unique_ptr<ApproximateAnalytics> approximate; // null in exact mode
+
+    // Add a sale to the sketches; they never subtract, so there is no sign
+    void sketchSale(const Order &order)
+    {
+        ApproximateAnalytics &sketches = *approximate;
+        int itemId = order.getItemId();
+        int buyerId = order.getBuyerId();
+        auto [entry, inserted] = sketches.sellers.try_emplace(order.getSellerId(), sketches.options);
+        SellerSketches &seller = entry->second;
+
+        sketches.itemUnits.add(itemId, order.getQuantity());
+        seller.items.offer(itemId, sketches.itemUnits.estimate(itemId));
+
+        int month = monthOf(order.getTimestamp());
+        if (month < sketches.month)
         {
-            if (order.getBuyerId() == buyerId)
-            {
-                buyerOrders.push_back(order);
-            }
+            return;
         }
-        return buyerOrders;
+        if (month > sketches.month)
+        {
+            sketches.month = month;
+            sketches.monthItemUnits = HeavyHitters(sketches.options);
+            sketches.monthPurchases = CountMinSketch(sketches.options.epsilon, sketches.options.delta);
+        }
+        if (seller.month != month)
+        {
+            seller.month = month;
+            seller.monthItems = TopCandidates(sketches.options.heavyHitters);
+            seller.repeatBuyers = TopCandidates(sketches.options.heavyHitters);
+            seller.buyers = HyperLogLog(sketches.options.hllPrecision);
+        }
+        sketches.monthItemUnits.add(itemId, order.getQuantity());
+        seller.monthItems.offer(itemId, sketches.monthItemUnits.estimate(itemId));
+        uint64_t buyerOfSeller = static_cast<uint64_t>(static_cast<uint32_t>(order.getSellerId())) << 32 |
+                        static_cast<uint32_t>(buyerId);
+        sketches.monthPurchases.add(buyerOfSeller, 1);
+        seller.repeatBuyers.offer(buyerId, sketches.monthPurchases.estimate(buyerOfSeller));
+        seller.buyers.add(static_cast<uint64_t>(buyerId));
     }
 
-    // Get orders by status
-    vector<Order> getOrdersByStatus(int userId, OrderStatus status, bool isBuyer = true) const
+    ThreadPool *analyticsPool; // splits whole-store scans when set
+    // Fewest items or orders worth handing to one worker. A scan is split into
+    // one chunk per thread (caller included) once every chunk gets this many,
+    // so the chunk size follows the data size and the pool's thread count.
+    static constexpr size_t ParallelGrain = 256;
+
+    // Orders placed today per buyer and per seller
+    DailyActivityCounter buyerActivity;
+    DailyActivityCounter sellerActivity;
+
+    static bool isSold(OrderStatus status) { return status == PAID || status == COMPLETED; }
+
+    // Add (sign 1) or take back (sign -1) an order in the sales, spend and loyalty totals
+    void recordSale(const Order &order, int sign)
     {
-        vector<Order> filteredOrders;
-        for (const auto &order : orders)
+        time_t day = localDay(order.getTimestamp());
+        buyerSpending[order.getBuyerId()].add(day, sign > 0 ? order.getTotalPrice() : -order.getTotalPrice());
+        if (approximate)
         {
-            if (isBuyer && order.getBuyerId() == userId && order.getStatus() == status)
+            if (sign > 0)
             {
-                filteredOrders.push_back(order);
-            }
-            else if (!isBuyer && order.getSellerId() == userId && order.getStatus() == status)
-            {
-                filteredOrders.push_back(order);
+                sketchSale(order);
             }
+            return;
+        }
+
+        auto [slot, inserted] = itemSalesSlots.try_emplace(order.getItemId(), itemSales.size());
+        if (inserted)
+        {
+            itemSales.push_back({order.getItemId(), order.getSellerId(), {}});
+            itemSalesBySeller[order.getSellerId()].push_back(slot->second);
+        }
+        itemSales[slot->second].units.add(day, sign * order.getQuantity());
+        recordMonthlyPurchase(order, sign);
+    }
+
+    // Count a new order towards today's buyer and seller activity
+    void recordOrderPlaced(const Order &order)
+    {
+        if (!approximate)
+        {
+            buyerActivity.add(order.getBuyerId(), order.getTimestamp());
+            sellerActivity.add(order.getSellerId(), order.getTimestamp());
+            return;
+        }
+
+        time_t day = localDay(order.getTimestamp());
+        if (day < approximate->day)
+        {
+            return;
+        }
+        if (day > approximate->day)
+        {
+            approximate->day = day;
+            approximate->buyerOrders = HeavyHitters(approximate->options);
+            approximate->sellerOrders = HeavyHitters(approximate->options);
+        }
+        approximate->buyerOrders.add(order.getBuyerId(), 1);
+        approximate->sellerOrders.add(order.getSellerId(), 1);
+    }
+
+    static vector<pair<int, int>> toCounts(const vector<pair<int, int64_t>> &estimates)
+    {
+        vector<pair<int, int>> counts;
+        for (const auto &entry : estimates)
+        {
+            counts.push_back({entry.first, static_cast<int>(entry.second)});
         }
-        return filteredOrders;
+        return counts;
+    }
+
+    static const vector<int> &orderIdsFor(const unordered_map<int, vector<int>> &index, int userId)
+    {
+        static const vector<int> none;
+        auto found = index.find(userId);
+        return found == index.end() ? none : found->second;
     }
 
-    // Get all orders for a seller
-    vector<Order> getSellerOrders(int sellerId) const
+    const Order *findOrder(int orderId) const
     {
-        vector<Order> sellerOrders;
-        for (const auto &order : orders)
+        if (orderId < 1 || static_cast<size_t>(orderId) > orderSlots.size())
         {
-            if (order.getSellerId() == sellerId)
+            return nullptr;
+        }
+        return &orders[orderSlots[orderId - 1]];
+    }
+
+    Order *findOrder(int orderId)
+    {
+        if (orderId < 1 || static_cast<size_t>(orderId) > orderSlots.size())
+        {
+            return nullptr;
+        }
+        return &orders[orderSlots[orderId - 1]];
+    }
+
+public:
+    Store(const string &name) : storeName(name), nextOrderId(1), analyticsPool(nullptr) {}
+
+    // Start a query over all orders; see OrderQuery
+    OrderQuery<> query() const;
+
+    // Run whole-store analytics on the given pool (nullptr: on the calling thread)
+    void setAnalyticsPool(ThreadPool *pool) { analyticsPool = pool; }
+
+    // Answer top items, most active buyers and sellers, distinct buyers and
+    // loyal customers from fixed-size sketches with the given error bounds
+    // instead of exact per-item, per-user and per-buyer tables. Existing
+    // orders are fed into the sketches and the exact tables are freed.
+    void enableApproximateAnalytics(const SketchOptions &options)
+    {
+        approximate = make_unique<ApproximateAnalytics>(options);
+        for (const Order &order : orders)
+        {
+            recordOrderPlaced(order);
+            if (isSold(order.getStatus()))
             {
-                sellerOrders.push_back(order);
+                sketchSale(order);
             }
         }
-        return sellerOrders;
+        itemSales = vector<ItemSales>();
+        itemSalesSlots = unordered_map<int, size_t>();
+        itemSalesBySeller = unordered_map<int, vector<size_t>>();
+        sellerBuyers = unordered_map<int, MonthlyBuyers>();
+        buyerActivity = DailyActivityCounter();
+        sellerActivity = DailyActivityCounter();
+    }
+
+    bool isApproximate() const { return approximate != nullptr; }
+
+    string getStoreName() const { return storeName; }
+
+    // The item index this store's sellers list their items in
+    ItemCatalog &getCatalog() { return catalog; }
+    const ItemCatalog &getCatalog() const { return catalog; }
+
+    // Current name of an item, empty when unknown
+    const string &getItemName(int itemId) const { return catalog.getName(itemId); }
+
+    // Create new order; returns its id, or 0 when quantity is outside [1, Order::MaxQuantity]
+    int createOrder(int buyerId, int sellerId, int itemId, int quantity, Money totalPrice)
+    {
+        if (!Order::isValidQuantity(quantity))
+        {
+            return 0;
+        }
+        orderSlots.push_back(orders.size());
+        orders.emplace_back(nextOrderId, buyerId, sellerId, itemId, quantity, totalPrice);
+        // the order table doubles as a time index, so never let the clock step it backwards
+        if (orders.size() > 1 && orders.back().getTimestamp() < orders[orders.size() - 2].getTimestamp())
+        {
+            orders.back().setTimestamp(orders[orders.size() - 2].getTimestamp());
+        }
+        ordersByBuyer[buyerId].push_back(nextOrderId);
+        ordersBySeller[sellerId].push_back(nextOrderId);
+        statusLinks.emplace_back();
+        linkStatus(nextOrderId, PENDING);
+        recordOrderPlaced(orders.back());
+        return nextOrderId++;
     }
 
-    // Get all paid but not completed orders
-    vector<Order> getPaidNotCompletedOrders() const
+    // Update order status
+    bool updateOrderStatus(int orderId, OrderStatus status)
     {
-        vector<Order> paidOrders;
-        for (const auto &order : orders)
+        Order *order = findOrder(orderId);
+        if (!order)
+        {
+            return false;
+        }
+        if (order->getStatus() != status)
         {
-            if (order.getStatus() == PAID)
+            if (isSold(status) != isSold(order->getStatus()))
             {
-                paidOrders.push_back(order);
+                recordSale(*order, isSold(status) ? 1 : -1);
             }
+            unlinkStatus(orderId, order->getStatus());
+            linkStatus(orderId, status);
+            order->setStatus(status);
         }
-        return paidOrders;
+        return true;
+    }
+
+    // Get orders placed in [from, until). Orders are stored in time order,
+    // so this is two binary searches and the result is a slice of the table.
+    span<const Order> getOrdersBetween(time_t from, time_t until) const
+    {
+        auto first = partition_point(orders.begin(), orders.end(),
+                                     [&](const Order &order)
+                                     {
+                                         return order.getTimestamp() < from;
+                                     });
+        auto last = partition_point(first, orders.end(),
+                                    [&](const Order &order)
+                                    {
+                                        return order.getTimestamp() < until;
+                                    });
+        return span<const Order>(first, last);
     }
 
     // Get transactions for last K days
-    vector<Order> getTransactionsLastKDays(int k) const
+    span<const Order> getTransactionsLastKDays(int k) const
     {
-        vector<Order> recentOrders;
         time_t now = time(nullptr);
         time_t kDaysAgo = now - (k * 24 * 60 * 60);
 
-        for (const auto &order : orders)
+        return getOrdersBetween(kDaysAgo, numeric_limits<time_t>::max());
+    }
+
+    // Get top M most sold items, by units in PAID or COMPLETED orders placed
+    // since the given time (whole days), for the whole store or one seller.
+    // Reads the live per-item counters and partially sorts them; with an
+    // analytics pool, chunks of items are ranked in parallel and merged.
+    // In approximate mode the window is this month when since falls in it,
+    // and all time otherwise, and units are upper-bound estimates.
+    vector<pair<string, int>> getTopMSoldItems(int m, time_t since = 0, int sellerId = 0) const
+    {
+        size_t limit = static_cast<size_t>(max(m, 0));
+        if (approximate)
         {
-            if (order.getTimestamp() >= kDaysAgo)
+            int month = monthOf(time(nullptr));
+            bool thisMonth = since > 0 && monthOf(since) >= month;
+            vector<pair<int, int64_t>> estimates;
+            if (sellerId)
+            {
+                auto found = approximate->sellers.find(sellerId);
+                if (found != approximate->sellers.end() && !thisMonth)
+                {
+                    estimates = found->second.items.top(limit);
+                }
+                else if (found != approximate->sellers.end() && found->second.month == month)
+                {
+                    estimates = found->second.monthItems.top(limit);
+                }
+            }
+            else if (!thisMonth)
+            {
+                estimates = approximate->itemUnits.top(limit);
+            }
+            else if (approximate->month == month)
             {
-                recentOrders.push_back(order);
+                estimates = approximate->monthItemUnits.top(limit);
             }
+
+            vector<pair<string, int>> topItems;
+            for (const auto &entry : estimates)
+            {
+                topItems.push_back({catalog.getName(entry.first), static_cast<int>(entry.second)});
+            }
+            return topItems;
         }
-        return recentOrders;
-    }
 
-    // Get top M most sold items
-    vector<pair<string, int>> getTopMSoldItems(int m) const
-    {
-        map<string, int> itemSales;
+        time_t sinceDay = localDay(since);
+        vector<pair<int, size_t>> ranked; // (units, index in itemSales)
+        auto rank = [&](size_t slot, vector<pair<int, size_t>> &out)
+        {
+            int units = itemSales[slot].units.sumFrom(sinceDay);
+            if (units > 0)
+            {
+                out.push_back({units, slot});
+            }
+        };
+        // Most units first, then lowest item id, so serial and parallel runs agree
+        auto keepTop = [&](vector<pair<int, size_t>> &candidates)
+        {
+            size_t top = min(candidates.size(), limit);
+            partial_sort(candidates.begin(), candidates.begin() + top, candidates.end(),
+                         [&](const pair<int, size_t> &a, const pair<int, size_t> &b)
+                         {
+                             if (a.first != b.first)
+                             {
+                                 return a.first > b.first;
+                             }
+                             return itemSales[a.second].itemId < itemSales[b.second].itemId;
+                         });
+            candidates.resize(top);
+        };
 
-        for (const auto &order : orders)
+        if (sellerId)
+        {
+            auto found = itemSalesBySeller.find(sellerId);
+            if (found != itemSalesBySeller.end())
+            {
+                for (size_t slot : found->second)
+                {
+                    rank(slot, ranked);
+                }
+            }
+        }
+        else if (analyticsPool)
+        {
+            vector<vector<pair<int, size_t>>> partials(analyticsPool->chunksFor(itemSales.size(), ParallelGrain));
+            analyticsPool->parallelFor(itemSales.size(), ParallelGrain,
+                                       [&](size_t chunk, size_t begin, size_t end)
+                                       {
+                                           for (size_t slot = begin; slot < end; slot++)
+                                           {
+                                               rank(slot, partials[chunk]);
+                                           }
+                                           keepTop(partials[chunk]);
+                                       });
+            for (const auto &partial : partials)
+            {
+                ranked.insert(ranked.end(), partial.begin(), partial.end());
+            }
+        }
+        else
         {
-            if (order.getStatus() == COMPLETED || order.getStatus() == PAID)
+            for (size_t slot = 0; slot < itemSales.size(); slot++)
             {
-                itemSales[order.getItemName()] += order.getQuantity();
+                rank(slot, ranked);
             }
         }
+        keepTop(ranked);
 
-        vector<pair<string, int>> salesVec(itemSales.begin(), itemSales.end());
-        sort(salesVec.begin(), salesVec.end(),
-             [](const pair<string, int> &a, const pair<string, int> &b)
-             {
-                 return a.second > b.second;
-             });
+        vector<pair<string, int>> topItems;
+        for (const auto &entry : ranked)
+        {
+            topItems.push_back({catalog.getName(itemSales[entry.second].itemId), entry.first});
+        }
+        return topItems;
+    }
 
-        if (salesVec.size() > (size_t)m)
+    // Get the n most active buyers by order count today
+    vector<pair<int, int>> getMostActiveBuyersToday(int n) const
+    {
+        time_t now = time(nullptr);
+        if (approximate)
         {
-            salesVec.resize(m);
+            bool today = localDay(now) == approximate->day;
+            return today ? toCounts(approximate->buyerOrders.top(static_cast<size_t>(max(n, 0)))) : vector<pair<int, int>>();
         }
+        return buyerActivity.top(static_cast<size_t>(max(n, 0)), now);
+    }
 
-        return salesVec;
+    // Get the n most active sellers by order count today
+    vector<pair<int, int>> getMostActiveSellersToday(int n) const
+    {
+        time_t now = time(nullptr);
+        if (approximate)
+        {
+            bool today = localDay(now) == approximate->day;
+            return today ? toCounts(approximate->sellerOrders.top(static_cast<size_t>(max(n, 0)))) : vector<pair<int, int>>();
+        }
+        return sellerActivity.top(static_cast<size_t>(max(n, 0)), now);
     }
 
-    // Get most active buyers by transaction count today
-    vector<pair<int, int>> getMostActiveBuyersToday() const
+    // Get buyer spending in last K days
+    Money getBuyerSpendingLastKDays(int buyerId, int k) const
     {
-        map<int, int> buyerTransactions;
         time_t now = time(nullptr);
-        time_t startOfDay = now - (now % 86400);
+        time_t kDaysAgo = now - (k * 24 * 60 * 60);
+
+        auto spending = buyerSpending.find(buyerId);
+        if (spending == buyerSpending.end())
+        {
+            return Money();
+        }
+
+        // Whole days come from the daily buckets
+        time_t startDay = localDay(kDaysAgo);
+        if (kDaysAgo == localDayStart(startDay))
+        {
+            return spending->second.sumFrom(startDay);
+        }
+        Money totalSpent = spending->second.sumFrom(startDay + 1);
 
-        for (const auto &order : orders)
+        // The partial first day comes from the buyer's own orders, which are in time order
+        time_t nextDay = localDayStart(startDay + 1);
+        const vector<int> &buyerOrders = orderIdsFor(ordersByBuyer, buyerId);
+        auto first = partition_point(buyerOrders.begin(), buyerOrders.end(),
+                                     [&](int orderId)
+                                     {
+                                         return findOrder(orderId)->getTimestamp() < kDaysAgo;
+                                     });
+        for (auto it = first; it != buyerOrders.end(); ++it)
         {
-            if (order.getTimestamp() >= startOfDay)
+            const Order *order = findOrder(*it);
+            if (order->getTimestamp() >= nextDay)
             {
-                buyerTransactions[order.getBuyerId()]++;
+                break;
+            }
+            if (isSold(order->getStatus()))
+            {
+                totalSpent += order->getTotalPrice();
             }
         }
+        return totalSpent;
+    }
 
-        vector<pair<int, int>> buyersVec(buyerTransactions.begin(), buyerTransactions.end());
-        sort(buyersVec.begin(), buyersVec.end(),
-             [](const pair<int, int> &a, const pair<int, int> &b)
-             {
-                 return a.second > b.second;
-             });
-
-        return buyersVec;
+    // Get order by ID (change its status through updateOrderStatus)
+    const Order *getOrderById(int orderId) const
+    {
+        return findOrder(orderId);
     }
 
-    // Get most active sellers by transaction count today
-    vector<pair<int, int>> getMostActiveSellersToday() const
+    // Get all orders, in creation order
+    span<const Order> getAllOrders() const
     {
-        map<int, int> sellerTransactions;
-        time_t now = time(nullptr);
-        time_t startOfDay = now - (now % 86400);
+        return orders;
+    }
 
-        for (const auto &order : orders)
+    // Get the number of different buyers who bought from a seller this month
+    // (an estimate in approximate mode, which still counts refunded buyers)
+    int getDistinctBuyersThisMonth(int sellerId) const
+    {
+        int month = monthOf(time(nullptr));
+        if (approximate)
         {
-            if (order.getTimestamp() >= startOfDay)
+            auto found = approximate->sellers.find(sellerId);
+            if (found == approximate->sellers.end() || found->second.month != month)
             {
-                sellerTransactions[order.getSellerId()]++;
+                return 0;
             }
+            return static_cast<int>(llround(found->second.buyers.estimate()));
         }
 
-        vector<pair<int, int>> sellersVec(sellerTransactions.begin(), sellerTransactions.end());
-        sort(sellersVec.begin(), sellersVec.end(),
-             [](const pair<int, int> &a, const pair<int, int> &b)
-             {
-                 return a.second > b.second;
-             });
-
-        return sellersVec;
+        auto found = sellerBuyers.find(sellerId);
+        if (found == sellerBuyers.end() || found->second.month != month)
+        {
+            return 0;
+        }
+        return static_cast<int>(found->second.purchases.size());
     }
 
-    // Get buyer spending in last K days
-    double getBuyerSpendingLastKDays(int buyerId, int k) const
+    // Get loyal customers for a seller (repeat buyers this month) as
+    // (buyer id, purchases) pairs by buyer id. In approximate mode only the
+    // SketchOptions::heavyHitters most frequent buyers are tracked, with
+    // upper-bound purchase estimates.
+    vector<pair<int, int>> getLoyalCustomers(int sellerId) const
     {
-        double totalSpent = 0.0;
-        time_t now = time(nullptr);
-        time_t kDaysAgo = now - (k * 24 * 60 * 60);
-
-        for (const auto &order : orders)
+        vector<pair<int, int>> loyalCustomers;
+        int month = monthOf(time(nullptr));
+        if (approximate)
         {
-            if (order.getBuyerId() == buyerId &&
-                order.getTimestamp() >= kDaysAgo &&
-                (order.getStatus() == PAID || order.getStatus() == COMPLETED))
+            auto found = approximate->sellers.find(sellerId);
+            if (found == approximate->sellers.end() || found->second.month != month)
             {
-                totalSpent += order.getTotalPrice();
+                return loyalCustomers;
             }
+            for (const auto &entry : toCounts(found->second.repeatBuyers.top(approximate->options.heavyHitters)))
+            {
+                if (entry.second > LoyaltyThreshold)
+                {
+                    loyalCustomers.push_back(entry);
+                }
+            }
+            sort(loyalCustomers.begin(), loyalCustomers.end());
+            return loyalCustomers;
         }
-        return totalSpent;
+
+        auto found = sellerBuyers.find(sellerId);
+        if (found == sellerBuyers.end() || found->second.month != month)
+        {
+            return loyalCustomers;
+        }
+
+        const MonthlyBuyers &buyersOfSeller = found->second;
+        for (int buyerId : buyersOfSeller.loyal)
+        {
+            loyalCustomers.push_back({buyerId, buyersOfSeller.purchases.at(buyerId)});
+        }
+        return loyalCustomers;
     }
+};
+
+// Order filters for OrderQuery; matches() is inlined into the scan loop
+struct BuyerIs
+{
+    int buyerId;
+    bool matches(const Order &order) const { return order.getBuyerId() == buyerId; }
+};
 
-    // Get order by ID
-    Order *getOrderById(int orderId)
+struct SellerIs
+{
+    int sellerId;
+    bool matches(const Order &order) const { return order.getSellerId() == sellerId; }
+};
+
+template <OrderStatus... Statuses>
+constexpr bool distinctStatuses()
+{
+    array<OrderStatus, sizeof...(Statuses)> statuses = {Statuses...};
+    for (size_t i = 0; i < statuses.size(); i++)
     {
-        for (auto &order : orders)
+        for (size_t j = i + 1; j < statuses.size(); j++)
         {
-            if (order.getOrderId() == orderId)
+            if (statuses[i] == statuses[j])
             {
-                return &order;
+                return false;
             }
         }
-        return nullptr;
     }
+    return true;
+}
+
+// Statuses must be distinct so a scan of the status lists visits each row
+// once; OrderQuery::status<...>() drops repeats before building one
+template <OrderStatus... Statuses>
+struct StatusIn
+{
+    static_assert(sizeof...(Statuses) > 0 && distinctStatuses<Statuses...>(), "StatusIn needs distinct statuses");
+    static constexpr OrderStatus statuses[] = {Statuses...};
+    bool matches(const Order &order) const { return ((order.getStatus() == Statuses) || ...); }
+};
+
+template <OrderStatus... Statuses>
+struct StatusPack
+{
+};
+
+// StatusIn over Kept plus the Rest not already in it, in first-seen order
+template <typename Kept, OrderStatus... Rest>
+struct DedupStatuses;
+
+template <OrderStatus... Kept>
+struct DedupStatuses<StatusPack<Kept...>>
+{
+    using type = StatusIn<Kept...>;
+};
+
+template <OrderStatus... Kept, OrderStatus Next, OrderStatus... Rest>
+struct DedupStatuses<StatusPack<Kept...>, Next, Rest...>
+    : DedupStatuses<conditional_t<((Kept == Next) || ...), StatusPack<Kept...>, StatusPack<Kept..., Next>>, Rest...>
+{
+};
+
+template <OrderStatus... Statuses>
+using DistinctStatusIn = typename DedupStatuses<StatusPack<>, Statuses...>::type;
+
+// A status chosen at run time, e.g. from a menu
+struct StatusIs
+{
+    OrderStatus status;
+    bool matches(const Order &order) const { return order.getStatus() == status; }
+};
+
+struct PlacedBetween
+{
+    time_t from;
+    time_t until;
+    bool matches(const Order &order) const { return order.getTimestamp() >= from && order.getTimestamp() < until; }
+};
+
+template <typename Filter>
+struct IsStatusIn : false_type
+{
+};
+
+template <OrderStatus... Statuses>
+struct IsStatusIn<StatusIn<Statuses...>> : true_type
+{
+};
+
+// Whether a filter is answered by walking status lists
+template <typename Filter>
+struct IsStatusFilter : bool_constant<IsStatusIn<Filter>::value || is_same_v<Filter, StatusIs>>
+{
+};
+
+// Whether a query's first filter reads rows from an order id index
+template <typename... Filters>
+struct LeadsWithIdIndex : false_type
+{
+};
 
-    // Get all orders
-    vector<Order> getAllOrders() const
+template <typename Leading, typename... Rest>
+struct LeadsWithIdIndex<Leading, Rest...>
+    : bool_constant<is_same_v<Leading, BuyerIs> || is_same_v<Leading, SellerIs> || IsStatusFilter<Leading>::value>
+{
+};
+
+// Whether a query's first filter is answered by slicing the order table by time
+template <typename... Filters>
+struct LeadsWithTimeWindow : false_type
+{
+};
+
+template <typename... Rest>
+struct LeadsWithTimeWindow<PlacedBetween, Rest...> : true_type
+{
+};
+
+// Orders filtered by a chain of predicates fixed at compile time, e.g.
+//     store.query().seller(id).status<PAID, COMPLETED>().count()
+// Every combination compiles to one loop with its checks inlined. The first
+// filter picks where rows come from: the buyer or seller index, the status
+// lists (for status<...>() and status(s) alike), the time slice of the order table, or else the whole table; the
+// index then stands in for that filter. Aggregates over a slice of the order
+// table (no id index) run in parallel on the store's analytics pool, one
+// partial result per chunk merged in table order, so they match a serial run;
+// filters must therefore be safe to call from several threads.
+template <typename... Filters>
+class OrderQuery
+{
+private:
+    static constexpr bool UsesIdIndex = LeadsWithIdIndex<Filters...>::value;
+    // Leading filters the table slice already applies
+    static constexpr size_t SliceFilters = LeadsWithTimeWindow<Filters...>::value ? 1 : 0;
+
+    const Store *store;
+    tuple<Filters...> filters;
+
+    template <size_t First, size_t... I>
+    bool matchesFrom(const Order &order, index_sequence<I...>) const
     {
-        return orders;
+        return (get<First + I>(filters).matches(order) && ...);
     }
 
-    // Get loyal customers for a seller (repeat buyers this month)
-    map<int, int> getLoyalCustomers(int sellerId) const
+    // Rows of an index-free query, before the filters after SliceFilters
+    span<const Order> tableSlice() const
     {
-        map<int, int> buyerPurchases;
-        time_t now = time(nullptr);
-        struct tm *timeInfo = localtime(&now);
-        timeInfo->tm_mday = 1;
-        timeInfo->tm_hour = 0;
-        timeInfo->tm_min = 0;
-        timeInfo->tm_sec = 0;
-        time_t startOfMonth = mktime(timeInfo);
-
-        for (const auto &order : orders)
-        {
-            if (order.getSellerId() == sellerId &&
-                order.getTimestamp() >= startOfMonth &&
-                (order.getStatus() == PAID || order.getStatus() == COMPLETED))
+        if constexpr (SliceFilters == 1)
+        {
+            return store->getOrdersBetween(get<0>(filters).from, get<0>(filters).until);
+        }
+        else
+        {
+            return store->getAllOrders();
+        }
+    }
+
+    bool matchesSlice(const Order &order) const
+    {
+        return matchesFrom<SliceFilters>(order, make_index_sequence<sizeof...(Filters) - SliceFilters>());
+    }
+
+    // Call visit(order) on each match until it returns false; returns
+    // whether the scan ran to the end
+    template <typename Visit>
+    bool scan(Visit &&visit) const
+    {
+        if constexpr (UsesIdIndex)
+        {
+            using Leading = tuple_element_t<0, tuple<Filters...>>;
+            const Leading &leading = get<0>(filters);
+            auto visitRest = [&](const Order &order)
+            {
+                return !matchesFrom<1>(order, make_index_sequence<sizeof...(Filters) - 1>()) || visit(order);
+            };
+
+            if constexpr (IsStatusFilter<Leading>::value)
+            {
+                auto walk = [&](OrderStatus status)
+                {
+                    for (int orderId = store->statusLists[status].head; orderId; orderId = store->statusLinks[orderId - 1].next)
+                    {
+                        if (!visitRest(*store->findOrder(orderId)))
+                        {
+                            return false;
+                        }
+                    }
+                    return true;
+                };
+                if constexpr (is_same_v<Leading, StatusIs>)
+                {
+                    return walk(leading.status);
+                }
+                else
+                {
+                    for (OrderStatus status : Leading::statuses)
+                    {
+                        if (!walk(status))
+                        {
+                            return false;
+                        }
+                    }
+                }
+            }
+            else
             {
-                buyerPurchases[order.getBuyerId()]++;
+                const auto &index = is_same_v<Leading, BuyerIs> ? store->ordersByBuyer : store->ordersBySeller;
+                int userId;
+                if constexpr (is_same_v<Leading, BuyerIs>)
+                {
+                    userId = leading.buyerId;
+                }
+                else
+                {
+                    userId = leading.sellerId;
+                }
+                for (int orderId : Store::orderIdsFor(index, userId))
+                {
+                    if (!visitRest(*store->findOrder(orderId)))
+                    {
+                        return false;
+                    }
+                }
             }
         }
+        else
+        {
+            for (const Order &order : tableSlice())
+            {
+                if (matchesSlice(order) && !visit(order))
+                {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
 
-        // Filter only buyers with more than 1 purchase
-        map<int, int> loyalCustomers;
-        for (const auto &pair : buyerPurchases)
+    // Fold the matching orders into a Partial with add(partial, order).
+    // Table slices big enough to split are folded per chunk on the analytics
+    // pool and the chunk partials merged in order with merge(into, from).
+    template <typename Partial, typename Add, typename Merge>
+    Partial aggregate(Add add, Merge merge) const
+    {
+        if constexpr (!UsesIdIndex)
         {
-            if (pair.second > 1)
+            span<const Order> rows = tableSlice();
+            ThreadPool *pool = store->analyticsPool;
+            size_t chunks = pool ? pool->chunksFor(rows.size(), Store::ParallelGrain) : 1;
+            if (chunks > 1)
             {
-                loyalCustomers[pair.first] = pair.second;
+                vector<Partial> partials(chunks);
+                pool->parallelFor(rows.size(), Store::ParallelGrain,
+                                  [&](size_t chunk, size_t begin, size_t end)
+                                  {
+                                      for (size_t i = begin; i < end; i++)
+                                      {
+                                          if (matchesSlice(rows[i]))
+                                          {
+                                              add(partials[chunk], rows[i]);
+                                          }
+                                      }
+                                  });
+                for (size_t chunk = 1; chunk < chunks; chunk++)
+                {
+                    merge(partials[0], partials[chunk]);
+                }
+                return std::move(partials[0]);
             }
         }
 
-        return loyalCustomers;
+        Partial total{};
+        scan([&](const Order &order)
+             {
+                 add(total, order);
+                 return true;
+             });
+        return total;
+    }
+
+public:
+    OrderQuery(const Store *store, tuple<Filters...> filters) : store(store), filters(filters) {}
+
+    // Add any filter type with a matches(const Order &) member
+    template <typename Filter>
+    OrderQuery<Filters..., Filter> where(Filter filter) const
+    {
+        return OrderQuery<Filters..., Filter>(store, tuple_cat(filters, tuple<Filter>(filter)));
+    }
+
+    OrderQuery<Filters..., BuyerIs> buyer(int buyerId) const { return where(BuyerIs{buyerId}); }
+    OrderQuery<Filters..., SellerIs> seller(int sellerId) const { return where(SellerIs{sellerId}); }
+    OrderQuery<Filters..., PlacedBetween> placedBetween(time_t from, time_t until) const { return where(PlacedBetween{from, until}); }
+
+    // Repeated statuses are dropped, so status<PAID, PAID>() reads PAID once
+    template <OrderStatus... Statuses>
+    OrderQuery<Filters..., DistinctStatusIn<Statuses...>> status() const { return where(DistinctStatusIn<Statuses...>{}); }
+    OrderQuery<Filters..., StatusIs> status(OrderStatus status) const { return where(StatusIs{status}); }
+
+    // Terminal operations
+
+    template <typename Visit>
+    void forEach(Visit visit) const
+    {
+        scan([&](const Order &order)
+             {
+                 visit(order);
+                 return true;
+             });
+    }
+
+    // Whether nothing matches; stops at the first match
+    bool empty() const
+    {
+        return scan([](const Order &)
+                    { return false; });
+    }
+
+    vector<Order> collect() const
+    {
+        return aggregate<vector<Order>>([](vector<Order> &result, const Order &order)
+                                        { result.push_back(order); },
+                                        [](vector<Order> &into, const vector<Order> &from)
+                                        { into.insert(into.end(), from.begin(), from.end()); });
+    }
+
+    size_t count() const
+    {
+        return aggregate<size_t>([](size_t &total, const Order &)
+                                 { total++; },
+                                 [](size_t &into, size_t from)
+                                 { into += from; });
+    }
+
+    Money sumPrice() const
+    {
+        return aggregate<Money>([](Money &total, const Order &order)
+                                { total += order.getTotalPrice(); },
+                                [](Money &into, Money from)
+                                { into += from; });
+    }
+
+    // Matching orders counted per keyOf(order)
+    template <typename KeyOf>
+    auto countBy(KeyOf keyOf) const
+    {
+        using Groups = unordered_map<decay_t<invoke_result_t<KeyOf, const Order &>>, size_t>;
+        return aggregate<Groups>([&](Groups &groups, const Order &order)
+                                 { groups[keyOf(order)]++; },
+                                 [](Groups &into, const Groups &from)
+                                 {
+                                     for (const auto &[key, count] : from)
+                                     {
+                                         into[key] += count;
+                                     }
+                                 });
+    }
+
+    // Matching orders' total price summed per keyOf(order)
+    template <typename KeyOf>
+    auto sumPriceBy(KeyOf keyOf) const
+    {
+        using Groups = unordered_map<decay_t<invoke_result_t<KeyOf, const Order &>>, Money>;
+        return aggregate<Groups>([&](Groups &groups, const Order &order)
+                                 { groups[keyOf(order)] += order.getTotalPrice(); },
+                                 [](Groups &into, const Groups &from)
+                                 {
+                                     for (const auto &[key, total] : from)
+                                     {
+                                         into[key] += total;
+                                     }
+                                 });
     }
 };
 
+inline OrderQuery<> Store::query() const
+{
+    return OrderQuery<>(this, {});
+}
+
 #endif // STORE_H
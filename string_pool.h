@@ -0,0 +1,66 @@
+#ifndef STRING_POOL_H
+#define STRING_POOL_H
+
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+using namespace std;
+
+// Interned strings addressed by a dense 32-bit id; id 0 is the empty string.
+// Looking up a string that is already interned does not allocate.
+// Safe to use from several threads.
+class StringPool
+{
+private:
+    mutable shared_mutex mtx;
+    deque<string> strings; // deque keeps the views in ids valid as it grows
+    unordered_map<string_view, uint32_t> ids;
+
+public:
+    StringPool() { intern(""); }
+
+    StringPool(const StringPool &) = delete;
+    StringPool &operator=(const StringPool &) = delete;
+
+    uint32_t intern(string_view text)
+    {
+        {
+            shared_lock<shared_mutex> lock(mtx);
+            auto found = ids.find(text);
+            if (found != ids.end())
+            {
+                return found->second;
+            }
+        }
+
+        unique_lock<shared_mutex> lock(mtx);
+        auto found = ids.find(text);
+        if (found != ids.end())
+        {
+            return found->second;
+        }
+        uint32_t id = static_cast<uint32_t>(strings.size());
+        strings.emplace_back(text);
+        ids.emplace(strings.back(), id);
+        return id;
+    }
+
+    const string &get(uint32_t id) const
+    {
+        shared_lock<shared_mutex> lock(mtx);
+        return strings[id];
+    }
+
+    size_t size() const
+    {
+        shared_lock<shared_mutex> lock(mtx);
+        return strings.size();
+    }
+};
+
+#endif // STRING_POOL_H
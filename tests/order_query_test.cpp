@@ -0,0 +1,178 @@
+// OrderQuery against a plain loop over the order table: every way a query
+// picks its rows (buyer index, seller index, compile-time and run-time status
+// lists, time slice, whole table) and every terminal must give the same
+// answer as testing each order by hand, serially and on an analytics pool.
+// Usage: order_query_test [orders]
+
+#include "store.h"
+#include "thread_pool.h"
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace
+{
+    constexpr int Buyers = 50;
+    constexpr int Sellers = 12;
+    constexpr int Items = 200;
+
+    int failures = 0;
+
+    void check(bool ok, const string &what)
+    {
+        if (!ok)
+        {
+            cerr << "FAIL: " << what << endl;
+            failures++;
+        }
+    }
+
+    vector<int> sortedIds(const vector<Order> &orders)
+    {
+        vector<int> ids;
+        for (const Order &order : orders)
+        {
+            ids.push_back(order.getOrderId());
+        }
+        sort(ids.begin(), ids.end());
+        return ids;
+    }
+
+    template <typename Groups>
+    map<typename Groups::key_type, typename Groups::mapped_type> ordered(const Groups &groups)
+    {
+        return {groups.begin(), groups.end()};
+    }
+
+    // Every terminal of query must agree with matches() applied to each order
+    template <typename Query, typename Matches>
+    void checkQuery(const Store &store, const Query &query, Matches matches, const string &what)
+    {
+        vector<Order> expected;
+        Money expectedTotal;
+        map<int, size_t> expectedPerSeller;
+        map<int, Money> expectedPerBuyer;
+        for (const Order &order : store.getAllOrders())
+        {
+            if (matches(order))
+            {
+                expected.push_back(order);
+                expectedTotal += order.getTotalPrice();
+                expectedPerSeller[order.getSellerId()]++;
+                expectedPerBuyer[order.getBuyerId()] += order.getTotalPrice();
+            }
+        }
+
+        check(sortedIds(query.collect()) == sortedIds(expected), what + ": collect");
+        check(query.count() == expected.size(),
+              what + ": count " + to_string(query.count()) + " vs " + to_string(expected.size()));
+        check(query.sumPrice() == expectedTotal, what + ": sumPrice");
+        check(query.empty() == expected.empty(), what + ": empty");
+        check(ordered(query.countBy([](const Order &order) { return order.getSellerId(); })) == expectedPerSeller,
+              what + ": countBy");
+        check(ordered(query.sumPriceBy([](const Order &order) { return order.getBuyerId(); })) == expectedPerBuyer,
+              what + ": sumPriceBy");
+
+        size_t visited = 0;
+        query.forEach([&](const Order &order)
+                      { visited += matches(order) ? 1 : 0; });
+        check(visited == expected.size(), what + ": forEach");
+    }
+
+    void checkAllPaths(const Store &store, const string &mode)
+    {
+        span<const Order> orders = store.getAllOrders();
+        time_t from = orders[orders.size() / 3].getTimestamp();
+        time_t until = orders[2 * orders.size() / 3].getTimestamp() + 1;
+        const int buyer = 3;
+        const int seller = 5;
+
+        checkQuery(store, store.query(), [](const Order &)
+                   { return true; },
+                   mode + " whole table");
+        checkQuery(store, store.query().buyer(buyer), [&](const Order &order)
+                   { return order.getBuyerId() == buyer; },
+                   mode + " buyer index");
+        checkQuery(store, store.query().buyer(Buyers + 1), [](const Order &)
+                   { return false; },
+                   mode + " unknown buyer");
+        checkQuery(store, store.query().seller(seller).status<PAID>(), [&](const Order &order)
+                   { return order.getSellerId() == seller && order.getStatus() == PAID; },
+                   mode + " seller index");
+        checkQuery(store, store.query().status<PAID, COMPLETED>().seller(seller), [&](const Order &order)
+                   { return (order.getStatus() == PAID || order.getStatus() == COMPLETED) && order.getSellerId() == seller; },
+                   mode + " status lists");
+        checkQuery(store, store.query().status<CANCELLED, CANCELLED>(), [](const Order &order)
+                   { return order.getStatus() == CANCELLED; },
+                   mode + " repeated status");
+        for (OrderStatus status : {PENDING, PAID, COMPLETED, CANCELLED})
+        {
+            checkQuery(store, store.query().status(status), [&](const Order &order)
+                       { return order.getStatus() == status; },
+                       mode + " run-time status " + to_string(status));
+        }
+        checkQuery(store, store.query().status(PENDING).buyer(buyer), [&](const Order &order)
+                   { return order.getStatus() == PENDING && order.getBuyerId() == buyer; },
+                   mode + " run-time status then buyer");
+        checkQuery(store, store.query().placedBetween(from, until).seller(seller), [&](const Order &order)
+                   { return order.getTimestamp() >= from && order.getTimestamp() < until && order.getSellerId() == seller; },
+                   mode + " time slice");
+        checkQuery(store, store.query().placedBetween(0, 1), [](const Order &)
+                   { return false; },
+                   mode + " empty time slice");
+        checkQuery(store, store.query().buyer(buyer).placedBetween(from, until), [&](const Order &order)
+                   { return order.getBuyerId() == buyer && order.getTimestamp() >= from && order.getTimestamp() < until; },
+                   mode + " buyer index then time");
+    }
+}
+
+int main(int argc, char **argv)
+{
+    int orderCount = argc > 1 ? atoi(argv[1]) : 20000;
+    if (orderCount <= 0)
+    {
+        cerr << "usage: order_query_test [orders]" << endl;
+        return 1;
+    }
+
+    Store store("query");
+    mt19937 rng(11);
+    uniform_int_distribution<int> pickBuyer(1, Buyers);
+    uniform_int_distribution<int> pickSeller(1, Sellers);
+    uniform_int_distribution<int> pickItem(1, Items);
+    uniform_int_distribution<int> pickQuantity(1, 5);
+    uniform_int_distribution<int> pickStatus(0, 3);
+    for (int i = 0; i < orderCount; i++)
+    {
+        int quantity = pickQuantity(rng);
+        int orderId = store.createOrder(pickBuyer(rng), pickSeller(rng), pickItem(rng), quantity,
+                                        Money::fromMinorUnits(quantity * 250));
+        // moving orders between statuses exercises unlinking from the status lists
+        store.updateOrderStatus(orderId, static_cast<OrderStatus>(pickStatus(rng)));
+        if (i % 7 == 0)
+        {
+            store.updateOrderStatus(orderId, static_cast<OrderStatus>(pickStatus(rng)));
+        }
+    }
+
+    checkAllPaths(store, "serial");
+    ThreadPool pool(4);
+    store.setAnalyticsPool(&pool);
+    checkAllPaths(store, "pooled");
+    store.setAnalyticsPool(nullptr);
+
+    if (failures)
+    {
+        cerr << failures << " checks failed" << endl;
+        return 1;
+    }
+    cout << "order queries OK (" << orderCount << " orders)" << endl;
+    return 0;
+}
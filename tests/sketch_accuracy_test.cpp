@@ -0,0 +1,247 @@
+// Approximate analytics against the exact path: the same skewed order stream
+// goes into an exact Store and an approximate one, and every sketch answer
+// must fall inside its stated error bound.
+// Usage: sketch_accuracy_test [orders]
+
+#include "store.h"
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace
+{
+    constexpr int Items = 4000;
+    constexpr int Sellers = 40;
+    constexpr int Buyers = 20000;
+
+    int failures = 0;
+
+    void check(bool ok, const string &what)
+    {
+        if (!ok)
+        {
+            cerr << "FAIL: " << what << endl;
+            failures++;
+        }
+    }
+
+    int sellerOf(int itemId) { return itemId % Sellers + 1; }
+
+    string itemName(int itemId) { return "item" + to_string(itemId); }
+
+    int itemIdOf(const string &name) { return stoi(name.substr(4)); }
+
+    // Zipf-like weights so a few ids dominate, as real sales do
+    discrete_distribution<int> skewed(int count, double exponent)
+    {
+        vector<double> weights(static_cast<size_t>(count));
+        for (int i = 0; i < count; i++)
+        {
+            weights[static_cast<size_t>(i)] = 1.0 / pow(i + 1, exponent);
+        }
+        return discrete_distribution<int>(weights.begin(), weights.end());
+    }
+
+    // Each estimate is at least the net count and at most the count ever
+    // added plus epsilon * total, the Count-Min guarantee for increments
+    template <typename Estimates>
+    void checkBounds(const Estimates &estimates, const map<int, int64_t> &net, const map<int, int64_t> &added,
+                     int64_t total, double epsilon, const string &what)
+    {
+        for (const auto &[id, estimate] : estimates)
+        {
+            auto low = net.find(id);
+            auto high = added.find(id);
+            int64_t floor = low == net.end() ? 0 : low->second;
+            int64_t ceiling = (high == added.end() ? 0 : high->second) + static_cast<int64_t>(ceil(epsilon * total));
+            check(estimate >= floor && estimate <= ceiling,
+                  what + " id " + to_string(id) + ": estimate " + to_string(estimate) +
+                      " outside [" + to_string(floor) + ", " + to_string(ceiling) + "]");
+        }
+    }
+
+    // At least `need` of the exact top ids appear in the approximate top
+    void checkRecall(const vector<int> &exact, const vector<int> &approximate, size_t need, const string &what)
+    {
+        set<int> found(approximate.begin(), approximate.end());
+        size_t hits = 0;
+        for (int id : exact)
+        {
+            hits += found.count(id);
+        }
+        check(hits >= need, what + ": recalled " + to_string(hits) + " of " + to_string(exact.size()));
+    }
+
+    template <typename Pairs>
+    vector<int> firstOf(const Pairs &pairs)
+    {
+        vector<int> ids;
+        for (const auto &entry : pairs)
+        {
+            ids.push_back(entry.first);
+        }
+        return ids;
+    }
+
+    vector<pair<int, int64_t>> itemEstimates(const vector<pair<string, int>> &topItems)
+    {
+        vector<pair<int, int64_t>> estimates;
+        for (const auto &[name, units] : topItems)
+        {
+            estimates.push_back({itemIdOf(name), units});
+        }
+        return estimates;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    int orderCount = argc > 1 ? atoi(argv[1]) : 200000;
+    if (orderCount <= 0)
+    {
+        cerr << "usage: sketch_accuracy_test [orders]" << endl;
+        return 1;
+    }
+
+    SketchOptions options;
+    Store exact("exact");
+    Store approximate("approximate");
+    for (int itemId = 1; itemId <= Items; itemId++)
+    {
+        exact.getCatalog().setName(itemId, itemName(itemId));
+        approximate.getCatalog().setName(itemId, itemName(itemId));
+    }
+
+    mt19937 rng(7);
+    auto pickItem = skewed(Items, 1.1);
+    auto pickBuyer = skewed(Buyers, 0.8);
+    uniform_int_distribution<int> pickQuantity(1, 5);
+    uniform_int_distribution<int> percent(0, 99);
+
+    // truth kept by the test: net and ever-added counts for the sketched totals
+    map<int, int64_t> netItemUnits, addedItemUnits, buyerOrders, sellerOrders;
+    map<int, map<int, int64_t>> netSellerItems, addedSellerItems;
+    // purchases per seller and buyer that reached the sketches: refunds only
+    // drop out when they happen before the switch to approximate mode
+    map<int, map<int, int>> sketchedPurchases;
+    int64_t addedUnits = 0;
+
+    for (int i = 0; i < orderCount; i++)
+    {
+        // switching halfway also covers rebuilding the sketches from existing orders
+        if (i == orderCount / 2)
+        {
+            approximate.enableApproximateAnalytics(options);
+        }
+
+        int itemId = pickItem(rng) + 1;
+        int sellerId = sellerOf(itemId);
+        int buyerId = pickBuyer(rng) + 1;
+        int quantity = pickQuantity(rng);
+        int orderId = exact.createOrder(buyerId, sellerId, itemId, quantity, Money());
+        approximate.createOrder(buyerId, sellerId, itemId, quantity, Money());
+        buyerOrders[buyerId]++;
+        sellerOrders[sellerId]++;
+
+        int roll = percent(rng);
+        if (roll < 70)
+        {
+            exact.updateOrderStatus(orderId, PAID);
+            approximate.updateOrderStatus(orderId, PAID);
+            netItemUnits[itemId] += quantity;
+            addedItemUnits[itemId] += quantity;
+            netSellerItems[sellerId][itemId] += quantity;
+            addedSellerItems[sellerId][itemId] += quantity;
+            sketchedPurchases[sellerId][buyerId]++;
+            addedUnits += quantity;
+            if (roll < 5)
+            {
+                // a refund the sketches cannot take back
+                exact.updateOrderStatus(orderId, CANCELLED);
+                approximate.updateOrderStatus(orderId, CANCELLED);
+                netItemUnits[itemId] -= quantity;
+                netSellerItems[sellerId][itemId] -= quantity;
+                if (!approximate.isApproximate() && --sketchedPurchases[sellerId][buyerId] == 0)
+                {
+                    sketchedPurchases[sellerId].erase(buyerId);
+                }
+            }
+        }
+    }
+    check(approximate.isApproximate() && !exact.isApproximate(), "mode switch");
+
+    const size_t top = 10;
+    const size_t need = top - 1;
+    // Store-wide top items, all time and this month
+    for (time_t since : {time_t(0), time(nullptr)})
+    {
+        string window = since ? "this month" : "all time";
+        auto exactTop = itemEstimates(exact.getTopMSoldItems(top, since));
+        auto approximateTop = itemEstimates(approximate.getTopMSoldItems(top, since));
+        checkBounds(approximateTop, netItemUnits, addedItemUnits, addedUnits, options.epsilon, "top items " + window);
+        checkRecall(firstOf(exactTop), firstOf(approximateTop), need, "top items " + window);
+    }
+
+    // Per-seller top items over the seller's own sales
+    for (int sellerId : {1, 2, Sellers / 2})
+    {
+        auto exactTop = itemEstimates(exact.getTopMSoldItems(5, time(nullptr), sellerId));
+        auto approximateTop = itemEstimates(approximate.getTopMSoldItems(5, time(nullptr), sellerId));
+        string what = "seller " + to_string(sellerId) + " top items";
+        checkBounds(approximateTop, netSellerItems[sellerId], addedSellerItems[sellerId], addedUnits, options.epsilon, what);
+        checkRecall(firstOf(exactTop), firstOf(approximateTop), 4, what);
+    }
+
+    // Today's most active buyers and sellers
+    auto exactBuyers = exact.getMostActiveBuyersToday(top);
+    auto approximateBuyers = approximate.getMostActiveBuyersToday(top);
+    checkBounds(approximateBuyers, buyerOrders, buyerOrders, orderCount, options.epsilon, "active buyers");
+    checkRecall(firstOf(exactBuyers), firstOf(approximateBuyers), need, "active buyers");
+
+    auto exactSellers = exact.getMostActiveSellersToday(top);
+    auto approximateSellers = approximate.getMostActiveSellersToday(top);
+    checkBounds(approximateSellers, sellerOrders, sellerOrders, orderCount, options.epsilon, "active sellers");
+    checkRecall(firstOf(exactSellers), firstOf(approximateSellers), need, "active sellers");
+
+    // Distinct buyers per seller this month, HyperLogLog within 5%; like the
+    // other sketches it keeps buyers whose purchases were refunded
+    for (int sellerId = 1; sellerId <= Sellers; sellerId++)
+    {
+        int truth = static_cast<int>(sketchedPurchases[sellerId].size());
+        check(exact.getDistinctBuyersThisMonth(sellerId) <= truth, "exact distinct buyers");
+        int estimate = approximate.getDistinctBuyersThisMonth(sellerId);
+        check(abs(estimate - truth) <= max(2.0, 0.05 * truth),
+              "distinct buyers of seller " + to_string(sellerId) + ": " + to_string(estimate) + " vs " + to_string(truth));
+    }
+
+    // The busiest repeat buyers of a seller are reported as loyal
+    for (int sellerId : {1, 2})
+    {
+        auto exactLoyal = exact.getLoyalCustomers(sellerId);
+        auto approximateLoyal = approximate.getLoyalCustomers(sellerId);
+        map<int, int> approximateCounts(approximateLoyal.begin(), approximateLoyal.end());
+        sort(exactLoyal.begin(), exactLoyal.end(),
+             [](const pair<int, int> &a, const pair<int, int> &b) { return a.second > b.second; });
+        for (size_t i = 0; i < min<size_t>(5, exactLoyal.size()); i++)
+        {
+            auto found = approximateCounts.find(exactLoyal[i].first);
+            check(found != approximateCounts.end() && found->second >= exactLoyal[i].second,
+                  "loyal buyer " + to_string(exactLoyal[i].first) + " of seller " + to_string(sellerId));
+        }
+    }
+
+    if (failures)
+    {
+        cerr << failures << " checks failed" << endl;
+        return 1;
+    }
+    cout << "sketch accuracy OK (" << orderCount << " orders)" << endl;
+    return 0;
+}
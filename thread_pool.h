@@ -0,0 +1,122 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+// Fixed set of worker threads used to split one scan into parallel chunks.
+// A pool of zero workers runs everything on the calling thread.
+class ThreadPool
+{
+private:
+    vector<thread> workers;
+    mutex mtx;
+    condition_variable wake;
+    deque<function<void()>> tasks;
+    bool stopping;
+
+    void workerLoop()
+    {
+        unique_lock<mutex> lock(mtx);
+        while (true)
+        {
+            wake.wait(lock, [&]
+                      { return stopping || !tasks.empty(); });
+            if (tasks.empty())
+            {
+                break;
+            }
+            function<void()> task = std::move(tasks.front());
+            tasks.pop_front();
+            lock.unlock();
+            task();
+            lock.lock();
+        }
+    }
+
+public:
+    explicit ThreadPool(size_t threads) : stopping(false)
+    {
+        for (size_t i = 0; i < threads; i++)
+        {
+            workers.emplace_back(&ThreadPool::workerLoop, this);
+        }
+    }
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    ~ThreadPool()
+    {
+        {
+            lock_guard<mutex> lock(mtx);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (auto &worker : workers)
+        {
+            worker.join();
+        }
+    }
+
+    size_t size() const { return workers.size(); }
+
+    // Number of chunks parallelFor splits count items into
+    size_t chunksFor(size_t count, size_t minChunk) const
+    {
+        size_t chunk = max<size_t>(minChunk, 1);
+        size_t byWork = (count + chunk - 1) / chunk;
+        return max<size_t>(1, min(workers.size() + 1, byWork));
+    }
+
+    // Call body(chunk, begin, end) for chunksFor(count, minChunk) contiguous
+    // chunks of [0, count). The calling thread runs chunk 0 and returns once
+    // every chunk is done, so body may write to per-chunk slots without locks.
+    template <typename Body>
+    void parallelFor(size_t count, size_t minChunk, Body body)
+    {
+        size_t chunks = chunksFor(count, minChunk);
+        if (chunks == 1)
+        {
+            body(0, 0, count);
+            return;
+        }
+
+        size_t per = (count + chunks - 1) / chunks;
+        mutex doneMutex;
+        condition_variable doneSignal;
+        size_t remaining = chunks - 1;
+        {
+            lock_guard<mutex> lock(mtx);
+            for (size_t chunk = 1; chunk < chunks; chunk++)
+            {
+                tasks.emplace_back([&, chunk]
+                                   {
+                                       body(chunk, min(count, chunk * per), min(count, (chunk + 1) * per));
+                                       lock_guard<mutex> doneLock(doneMutex);
+                                       if (--remaining == 0)
+                                       {
+                                           doneSignal.notify_one();
+                                       }
+                                   });
+            }
+        }
+        wake.notify_all();
+
+        body(0, 0, min(count, per));
+
+        unique_lock<mutex> lock(doneMutex);
+        doneSignal.wait(lock, [&]
+                        { return remaining == 0; });
+    }
+};
+
+#endif // THREAD_POOL_H
@@ -1,8 +1,13 @@
 #ifndef TRANSACTION_H
 #define TRANSACTION_H
 
+#include <algorithm>
 #include <string>
+#include <cstdint>
 #include <ctime>
+#include <type_traits>
+#include <vector>
+#include "money.h"
 
 using namespace std;
 
@@ -19,6 +24,15 @@ enum OrderStatus
     CANCELLED
 };
 
+// Compact records keep time as 32-bit seconds since 2020-01-01 00:00:00 UTC
+constexpr time_t RecordEpoch = 1577836800;
+
+// Times outside the 32-bit range are clamped to its ends
+inline uint32_t toRecordTime(time_t timestamp)
+{
+    return static_cast<uint32_t>(clamp<int64_t>(timestamp - RecordEpoch, 0, UINT32_MAX));
+}
+
 // Bank Transaction
 class Transaction
 {
@@ -26,12 +40,12 @@ private:
     int id;
     int customerId;
     TransactionType type;
-    double amount;
+    Money amount;
     time_t timestamp;
     string description;
 
 public:
-    Transaction(int id, int customerId, TransactionType type, double amount, const string &desc)
+    Transaction(int id, int customerId, TransactionType type, Money amount, const string &desc)
         : id(id), customerId(customerId), type(type), amount(amount), description(desc)
     {
         timestamp = time(nullptr);
@@ -40,49 +54,51 @@ public:
     int getId() const { return id; }
     int getCustomerId() const { return customerId; }
     TransactionType getType() const { return type; }
-    double getAmount() const { return amount; }
+    Money getAmount() const { return amount; }
     time_t getTimestamp() const { return timestamp; }
     string getDescription() const { return description; }
 
     void setTimestamp(time_t ts) { timestamp = ts; }
 };
 
-// Store Order/Transaction
+// Store Order/Transaction, packed into 32 bytes with no heap data
 class Order
 {
 private:
-    int orderId;
-    int buyerId;
-    int sellerId;
-    int itemId;
-    string itemName;
-    int quantity;
-    double totalPrice;
-    OrderStatus status;
-    time_t timestamp;
+    Money totalPrice;
+    int32_t orderId;
+    int32_t buyerId;
+    int32_t sellerId;
+    int32_t itemId;
+    uint32_t timestamp; // seconds since RecordEpoch
+    uint32_t quantity : 28;
+    uint32_t status : 4; // OrderStatus
 
 public:
-    Order(int orderId, int buyerId, int sellerId, int itemId, const string &itemName,
-          int quantity, double totalPrice)
-        : orderId(orderId), buyerId(buyerId), sellerId(sellerId), itemId(itemId),
-          itemName(itemName), quantity(quantity), totalPrice(totalPrice)
-    {
-        status = PENDING;
-        timestamp = time(nullptr);
-    }
+    // Largest quantity the 28-bit field holds
+    static constexpr int MaxQuantity = (1 << 28) - 1;
+
+    static bool isValidQuantity(int quantity) { return quantity >= 1 && quantity <= MaxQuantity; }
+
+    // quantity must satisfy isValidQuantity; the item's name lives in the store's ItemCatalog
+    Order(int orderId, int buyerId, int sellerId, int itemId, int quantity, Money totalPrice)
+        : totalPrice(totalPrice), orderId(orderId), buyerId(buyerId), sellerId(sellerId), itemId(itemId),
+          timestamp(toRecordTime(time(nullptr))), quantity(static_cast<uint32_t>(quantity)), status(PENDING) {}
 
     int getOrderId() const { return orderId; }
     int getBuyerId() const { return buyerId; }
     int getSellerId() const { return sellerId; }
     int getItemId() const { return itemId; }
-    string getItemName() const { return itemName; }
-    int getQuantity() const { return quantity; }
-    double getTotalPrice() const { return totalPrice; }
-    OrderStatus getStatus() const { return status; }
-    time_t getTimestamp() const { return timestamp; }
+    int getQuantity() const { return static_cast<int>(quantity); }
+    Money getTotalPrice() const { return totalPrice; }
+    OrderStatus getStatus() const { return static_cast<OrderStatus>(status); }
+    time_t getTimestamp() const { return RecordEpoch + timestamp; }
 
     void setStatus(OrderStatus newStatus) { status = newStatus; }
-    void setTimestamp(time_t ts) { timestamp = ts; }
+    void setTimestamp(time_t ts) { timestamp = toRecordTime(ts); }
 };
 
+static_assert(sizeof(Order) == 32, "Order should stay 32 bytes");
+static_assert(is_trivially_copyable_v<Order>);
+
 #endif // TRANSACTION_H
@@ -0,0 +1,388 @@
+#ifndef WAL_H
+#define WAL_H
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
+#include <functional>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+using namespace std;
+
+enum WalRecordType : uint8_t
+{
+    WAL_CREATE_ACCOUNT = 1,
+    WAL_TOP_UP,
+    WAL_WITHDRAW,
+    WAL_RECORD_TRANSACTION,
+    WAL_TRANSFER
+};
+
+// One logged Bank mutation. text is the customer name, description or memo;
+// counterpartyId is the credited account of a transfer. text only views the
+// caller's string (or, during replay, the log buffer) and is copied when encoded.
+struct WalRecord
+{
+    WalRecordType type;
+    int32_t accountId;
+    uint8_t transactionType;
+    int64_t amount; // Money minor units
+    int64_t timestamp;
+    string_view text;
+    int32_t counterpartyId = 0;
+};
+
+// Group commit knobs: a batch is written and fdatasync'ed once it holds
+// maxBatchBytes or its oldest record has waited commitDelay, whichever is first.
+// With waitForDurable, mutations return only after their batch is on disk.
+struct WalOptions
+{
+    chrono::microseconds commitDelay = chrono::milliseconds(2);
+    size_t maxBatchBytes = 64 * 1024;
+    bool waitForDurable = true;
+};
+
+// Append-only binary write-ahead log with a background group-commit thread.
+// On disk the log starts with an 8-byte header, "BANKWAL" plus a format
+// version byte, followed by records of [u32 payload size][u32 checksum][payload].
+class WriteAheadLog
+{
+private:
+    static constexpr char Magic[7] = {'B', 'A', 'N', 'K', 'W', 'A', 'L'};
+    static constexpr uint8_t Version = 1; // bump when the payload layout changes
+    static constexpr size_t HeaderSize = sizeof(Magic) + 1;
+
+    int fd;
+    WalOptions options;
+    mutable mutex mtx;
+    condition_variable flushRequested;
+    condition_variable flushed;
+    vector<char> pending;
+    uint64_t appendedLsn;
+    uint64_t durableLsn;
+    bool syncRequested;
+    bool stopping;
+    bool ioFailed;
+    thread flusher;
+
+    static uint32_t checksum(const char *data, size_t size)
+    {
+        uint32_t hash = 2166136261u;
+        for (size_t i = 0; i < size; i++)
+        {
+            hash = (hash ^ static_cast<uint8_t>(data[i])) * 16777619u;
+        }
+        return hash;
+    }
+
+    template <typename T>
+    static void put(vector<char> &out, T value)
+    {
+        char bytes[sizeof(T)];
+        memcpy(bytes, &value, sizeof(T));
+        out.insert(out.end(), bytes, bytes + sizeof(T));
+    }
+
+    template <typename T>
+    static bool get(const char *&cursor, const char *end, T &value)
+    {
+        if (static_cast<size_t>(end - cursor) < sizeof(T))
+        {
+            return false;
+        }
+        memcpy(&value, cursor, sizeof(T));
+        cursor += sizeof(T);
+        return true;
+    }
+
+    // Encode straight into out, then fill in the header; no temporary buffer
+    static void encode(vector<char> &out, const WalRecord &record)
+    {
+        size_t header = out.size();
+        put(out, static_cast<uint32_t>(0)); // payload size
+        put(out, static_cast<uint32_t>(0)); // checksum
+        size_t payload = out.size();
+
+        put(out, static_cast<uint8_t>(record.type));
+        put(out, record.accountId);
+        put(out, record.counterpartyId);
+        put(out, record.transactionType);
+        put(out, record.amount);
+        put(out, record.timestamp);
+        put(out, static_cast<uint32_t>(record.text.size()));
+        out.insert(out.end(), record.text.begin(), record.text.end());
+
+        uint32_t size = static_cast<uint32_t>(out.size() - payload);
+        uint32_t sum = checksum(out.data() + payload, size);
+        memcpy(out.data() + header, &size, sizeof(size));
+        memcpy(out.data() + header + sizeof(size), &sum, sizeof(sum));
+    }
+
+    static bool decode(const char *payload, size_t size, WalRecord &record)
+    {
+        const char *cursor = payload;
+        const char *end = payload + size;
+        uint8_t type;
+        uint32_t textSize;
+        if (!get(cursor, end, type) || !get(cursor, end, record.accountId) ||
+            !get(cursor, end, record.counterpartyId) || !get(cursor, end, record.transactionType) ||
+            !get(cursor, end, record.amount) || !get(cursor, end, record.timestamp) || !get(cursor, end, textSize) ||
+            static_cast<size_t>(end - cursor) != textSize)
+        {
+            return false;
+        }
+        record.type = static_cast<WalRecordType>(type);
+        record.text = string_view(cursor, textSize);
+        return true;
+    }
+
+    static vector<char> fileHeader()
+    {
+        vector<char> bytes(Magic, Magic + sizeof(Magic));
+        bytes.push_back(static_cast<char>(Version));
+        return bytes;
+    }
+
+    // Read the record at cursor; cursor moves past it on success
+    static bool readRecord(const char *&cursor, const char *end, WalRecord &record)
+    {
+        const char *start = cursor;
+        uint32_t size;
+        uint32_t sum;
+        if (!get(cursor, end, size) || !get(cursor, end, sum) ||
+            static_cast<size_t>(end - cursor) < size ||
+            checksum(cursor, size) != sum || !decode(cursor, size, record))
+        {
+            cursor = start;
+            return false;
+        }
+        cursor += size;
+        return true;
+    }
+
+    static bool writeAll(int fd, const char *data, size_t size)
+    {
+        while (size > 0)
+        {
+            ssize_t written = ::write(fd, data, size);
+            if (written < 0)
+            {
+                return false;
+            }
+            data += written;
+            size -= static_cast<size_t>(written);
+        }
+        return true;
+    }
+
+    // Background thread: one write + fdatasync per batch of appended records
+    void flushLoop()
+    {
+        unique_lock<mutex> lock(mtx);
+        while (true)
+        {
+            flushRequested.wait(lock, [&]
+                                { return stopping || syncRequested || !pending.empty(); });
+            if (pending.empty() && stopping)
+            {
+                break;
+            }
+
+            // Let the batch fill up unless it is already big enough or someone is waiting on sync()
+            flushRequested.wait_for(lock, options.commitDelay, [&]
+                                    { return stopping || syncRequested || pending.size() >= options.maxBatchBytes; });
+
+            vector<char> batch;
+            batch.swap(pending);
+            uint64_t batchLsn = appendedLsn;
+            syncRequested = false;
+
+            lock.unlock();
+            bool ok = batch.empty() || (writeAll(fd, batch.data(), batch.size()) && fdatasync(fd) == 0);
+            lock.lock();
+
+            ioFailed = ioFailed || !ok;
+            durableLsn = batchLsn;
+            flushed.notify_all();
+        }
+    }
+
+public:
+    // Open (or create) the log at path for appending. A non-empty file must
+    // already carry the current header; otherwise the log stays closed rather
+    // than mixing formats in one file.
+    WriteAheadLog(const string &path, WalOptions options = WalOptions())
+        : fd(::open(path.c_str(), O_RDWR | O_CREAT | O_APPEND, 0644)), options(options),
+          appendedLsn(0), durableLsn(0), syncRequested(false), stopping(false), ioFailed(false)
+    {
+        if (fd < 0)
+        {
+            return;
+        }
+
+        vector<char> expected = fileHeader();
+        bool usable;
+        if (::lseek(fd, 0, SEEK_END) == 0)
+        {
+            usable = writeAll(fd, expected.data(), expected.size()) && fdatasync(fd) == 0;
+        }
+        else
+        {
+            vector<char> found(HeaderSize);
+            usable = ::pread(fd, found.data(), found.size(), 0) == static_cast<ssize_t>(found.size()) &&
+                     found == expected;
+        }
+        if (!usable)
+        {
+            ::close(fd);
+            fd = -1;
+            return;
+        }
+        flusher = thread(&WriteAheadLog::flushLoop, this);
+    }
+
+    WriteAheadLog(const WriteAheadLog &) = delete;
+    WriteAheadLog &operator=(const WriteAheadLog &) = delete;
+
+    ~WriteAheadLog()
+    {
+        if (fd < 0)
+        {
+            return;
+        }
+        {
+            lock_guard<mutex> lock(mtx);
+            stopping = true;
+        }
+        flushRequested.notify_one();
+        flusher.join();
+        ::close(fd);
+    }
+
+    bool isOpen() const { return fd >= 0; }
+    bool waitsForDurable() const { return options.waitForDurable; }
+
+    // True once a write or fdatasync has failed; records after that may be lost
+    bool hasFailed() const
+    {
+        lock_guard<mutex> lock(mtx);
+        return ioFailed;
+    }
+
+    // Queue a record for the next group commit and return its log sequence
+    // number, or 0 when the log could not be opened
+    uint64_t append(const WalRecord &record)
+    {
+        if (fd < 0)
+        {
+            return 0;
+        }
+        lock_guard<mutex> lock(mtx);
+        bool startsBatch = pending.empty();
+        encode(pending, record);
+        if (startsBatch || pending.size() >= options.maxBatchBytes)
+        {
+            flushRequested.notify_one();
+        }
+        return ++appendedLsn;
+    }
+
+    // Block until the batch holding lsn has been fdatasync'ed; false if the log
+    // is not open or hit an I/O error
+    bool waitDurable(uint64_t lsn)
+    {
+        if (fd < 0)
+        {
+            return false;
+        }
+        unique_lock<mutex> lock(mtx);
+        flushed.wait(lock, [&]
+                     { return durableLsn >= lsn; });
+        return !ioFailed;
+    }
+
+    // Commit everything appended so far without waiting out the commit delay
+    bool sync()
+    {
+        if (fd < 0)
+        {
+            return false;
+        }
+        unique_lock<mutex> lock(mtx);
+        uint64_t target = appendedLsn;
+        if (durableLsn < target)
+        {
+            syncRequested = true;
+            flushRequested.notify_one();
+            flushed.wait(lock, [&]
+                         { return durableLsn >= target; });
+        }
+        return !ioFailed;
+    }
+
+    // Feed every intact record of the log at path to apply, in order.
+    // A record's text is only valid for the duration of the apply call.
+    // A torn or corrupt tail (e.g. from a crash mid-write, even inside the
+    // first record or the header itself) is cut off. Throws runtime_error,
+    // leaving the file untouched, when it is not a bank log or its format
+    // version is unknown.
+    static size_t replay(const string &path, const function<void(const WalRecord &)> &apply)
+    {
+        int in = ::open(path.c_str(), O_RDONLY);
+        if (in < 0)
+        {
+            return 0;
+        }
+
+        vector<char> data;
+        char buffer[1 << 16];
+        ssize_t bytes;
+        while ((bytes = ::read(in, buffer, sizeof(buffer))) > 0)
+        {
+            data.insert(data.end(), buffer, buffer + bytes);
+        }
+        ::close(in);
+
+        vector<char> header = fileHeader();
+        size_t headerBytes = min(data.size(), HeaderSize);
+        if (!equal(data.begin(), data.begin() + static_cast<ptrdiff_t>(min(headerBytes, sizeof(Magic))), Magic))
+        {
+            throw runtime_error(path + ": not a bank log; refusing to replay or truncate it");
+        }
+        if (headerBytes == HeaderSize && data[sizeof(Magic)] != header.back())
+        {
+            throw runtime_error(path + ": unsupported bank log format version");
+        }
+
+        size_t records = 0;
+        const char *cursor = data.data() + headerBytes;
+        const char *end = data.data() + data.size();
+        WalRecord record;
+        while (readRecord(cursor, end, record))
+        {
+            apply(record);
+            records++;
+        }
+
+        // Drop the torn tail so new records follow the last intact one; a
+        // torn header leaves an empty file for the constructor to start over
+        size_t validBytes = headerBytes == HeaderSize ? static_cast<size_t>(cursor - data.data()) : 0;
+        if (validBytes < data.size())
+        {
+            int result = ::truncate(path.c_str(), static_cast<off_t>(validBytes));
+            (void)result;
+        }
+        return records;
+    }
+};
+
+#endif // WAL_H